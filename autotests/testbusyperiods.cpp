@@ -0,0 +1,126 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testbusyperiods.h"
+
+#include "busyperiods_p.h"
+
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(BusyPeriodsTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+static QDateTime dt(int day, int hour, int minute = 0)
+{
+    return QDateTime(QDate(2015, 10, day), QTime(hour, minute), QTimeZone::utc());
+}
+
+void BusyPeriodsTest::testCoalesce()
+{
+    const Period::List periods = {
+        Period(dt(5, 14), dt(5, 15)),
+        Period(dt(5, 9), dt(5, 10)),
+        Period(dt(5, 9, 30), Duration(3600)), // overlaps the previous one
+        Period(dt(5, 10, 30), dt(5, 11)), // adjacent to the previous one
+        Period(dt(5, 14, 15), dt(5, 14, 45)), // inside the first one
+    };
+
+    const Period::List result = BusyPeriods::coalesce(periods);
+    QCOMPARE(result.count(), 2);
+    QCOMPARE(result.at(0).start(), dt(5, 9));
+    QCOMPARE(result.at(0).end(), dt(5, 11));
+    QCOMPARE(result.at(1).start(), dt(5, 14));
+    QCOMPARE(result.at(1).end(), dt(5, 15));
+}
+
+void BusyPeriodsTest::testCoalesceKeepsSeparatePeriods()
+{
+    const Period::List periods = {
+        Period(dt(12, 9, 30), Duration(1800)),
+        Period(dt(5, 9, 30), dt(5, 10)),
+    };
+
+    const Period::List result = BusyPeriods::coalesce(periods);
+    QCOMPARE(result.count(), 2);
+    QCOMPARE(result.at(0), periods.at(1));
+    QCOMPARE(result.at(1), periods.at(0));
+    QVERIFY(result.at(1).hasDuration());
+}
+
+void BusyPeriodsTest::testTimeline()
+{
+    const Period::List periods = {
+        Period(dt(5, 9, 30), dt(5, 10)),
+        Period(dt(5, 12, 10), dt(5, 12, 20)), // rounded outwards to 12:00 - 12:30
+        Period(dt(6, 22), dt(8, 0)), // spans into the next day, ends at midnight
+    };
+
+    const QList<BusyPeriods::DayTimeline> timeline = BusyPeriods::timeline(periods, dt(1, 0), dt(31, 0));
+    QCOMPARE(timeline.count(), 3);
+
+    QCOMPARE(timeline.at(0).date, QDate(2015, 10, 5));
+    QCOMPARE(timeline.at(0).ranges.count(), 2);
+    QCOMPARE(timeline.at(0).ranges.at(0), qMakePair(38, 40));
+    QCOMPARE(timeline.at(0).ranges.at(1), qMakePair(48, 50));
+
+    QCOMPARE(timeline.at(1).date, QDate(2015, 10, 6));
+    QCOMPARE(timeline.at(1).ranges.count(), 1);
+    QCOMPARE(timeline.at(1).ranges.at(0), qMakePair(88, BusyPeriods::slotsPerDay));
+
+    QCOMPARE(timeline.at(2).date, QDate(2015, 10, 7));
+    QCOMPARE(timeline.at(2).ranges.count(), 1);
+    QCOMPARE(timeline.at(2).ranges.at(0), qMakePair(0, BusyPeriods::slotsPerDay));
+}
+
+void BusyPeriodsTest::testTimelineIsBoundedByDays()
+{
+    // A busy resource: a 5 minute booking every 10 minutes for 30 days
+    Period::List periods;
+    for (int day = 1; day <= 30; ++day) {
+        for (int minute = 0; minute < 24 * 60; minute += 10) {
+            const QDateTime start = dt(day, 0).addSecs(minute * 60);
+            periods.append(Period(start, start.addSecs(5 * 60)));
+        }
+    }
+
+    const Period::List coalesced = BusyPeriods::coalesce(periods);
+    QCOMPARE(coalesced.count(), periods.count());
+
+    const QList<BusyPeriods::DayTimeline> timeline = BusyPeriods::timeline(coalesced, dt(1, 0), dt(31, 0));
+    QCOMPARE(timeline.count(), 30);
+    for (const BusyPeriods::DayTimeline &day : timeline) {
+        QCOMPARE(day.ranges.count(), 1);
+        QCOMPARE(day.ranges.at(0), qMakePair(0, BusyPeriods::slotsPerDay));
+    }
+}
+
+void BusyPeriodsTest::testTimelineIsClampedToRange()
+{
+    // FREEBUSY:19000101T000000Z/99991231T000000Z
+    const Period::List periods = {
+        Period(QDateTime(QDate(1900, 1, 1), QTime(0, 0), QTimeZone::utc()), QDateTime(QDate(9999, 12, 31), QTime(0, 0), QTimeZone::utc())),
+    };
+
+    const QList<BusyPeriods::DayTimeline> clamped = BusyPeriods::timeline(periods, dt(5, 0), dt(8, 0));
+    QVERIFY(!clamped.isEmpty());
+    QVERIFY(clamped.count() <= 4);
+    QVERIFY(clamped.constFirst().date >= QDate(2015, 10, 4));
+    QVERIFY(clamped.constLast().date <= QDate(2015, 10, 8));
+
+    // The free/busy range itself may be just as long
+    const QList<BusyPeriods::DayTimeline> capped = BusyPeriods::timeline(periods, periods.constFirst().start(), periods.constFirst().end());
+    QVERIFY(!capped.isEmpty());
+    QVERIFY(capped.count() <= BusyPeriods::maxTimelineDays);
+    QVERIFY(capped.constFirst().date.year() <= 1900);
+
+    const QList<BusyPeriods::DayTimeline> unbounded = BusyPeriods::timeline(periods, QDateTime(), QDateTime());
+    QVERIFY(unbounded.count() <= BusyPeriods::maxTimelineDays);
+}
+
+#include "moc_testbusyperiods.cpp"
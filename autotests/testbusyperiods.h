@@ -0,0 +1,21 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class BusyPeriodsTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCoalesce();
+    void testCoalesceKeepsSeparatePeriods();
+    void testTimeline();
+    void testTimelineIsBoundedByDays();
+    void testTimelineIsClampedToRange();
+};
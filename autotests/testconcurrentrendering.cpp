@@ -0,0 +1,131 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testconcurrentrendering.h"
+#include "test_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QFile>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QThread>
+#include <QTimeZone>
+
+#include <memory>
+#include <vector>
+
+QTEST_MAIN(ConcurrentRenderingTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+namespace
+{
+constexpr int threadCount = 8;
+constexpr int iterations = 5;
+
+Event::Ptr monthDayEvent(int day)
+{
+    Event::Ptr event(new Event);
+    event->setDtStart(QDateTime(QDate(2024, 1, 1), QTime(10, 0), QTimeZone::utc()));
+    event->recurrence()->setMonthly(1);
+    event->recurrence()->addMonthlyDate(day);
+    return event;
+}
+
+// Everything rendered here goes through the per-thread template manager
+// and the formatter helpers that used to keep function-local state.
+QStringList renderAll()
+{
+    QStringList result;
+
+    const QStringList invitations = {QStringLiteral("itip-event-request"),
+                                     QStringLiteral("itip-event-accepted-reply"),
+                                     QStringLiteral("itip-event-with-html-description"),
+                                     QStringLiteral("itip-event-with-recurrence-attachment-reminder")};
+    for (const QString &name : invitations) {
+        QFile file(QStringLiteral(TEST_DATA_DIR "/%1.ical").arg(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+        MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+        InvitationFormatterHelper helper;
+        result.append(IncidenceFormatter::formatICalInvitation(QString::fromUtf8(file.readAll()), calendar, &helper));
+    }
+
+    const QStringList displays = {QStringLiteral("event-1"), QStringLiteral("event-multiday"), QStringLiteral("todo-1"), QStringLiteral("journal-1")};
+    for (const QString &name : displays) {
+        auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+        ICalFormat format;
+        if (!format.load(calendar, QStringLiteral(TEST_DATA_DIR "/%1.ical").arg(name))) {
+            return {};
+        }
+        const Incidence::List incidences = calendar->incidences();
+        for (const Incidence::Ptr &incidence : incidences) {
+            result.append(IncidenceFormatter::extensiveDisplayStr(calendar, incidence));
+            result.append(IncidenceFormatter::recurrenceString(incidence));
+        }
+    }
+
+    for (int day : {-31, -2, -1, 1, 2, 3, 31}) {
+        result.append(IncidenceFormatter::recurrenceString(monthDayEvent(day)));
+    }
+    return result;
+}
+}
+
+void ConcurrentRenderingTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void ConcurrentRenderingTest::testMonthDayRecurrence()
+{
+    QCOMPARE(IncidenceFormatter::recurrenceString(monthDayEvent(1)), QStringLiteral("Recurs monthly on the 1st day"));
+    QCOMPARE(IncidenceFormatter::recurrenceString(monthDayEvent(22)), QStringLiteral("Recurs monthly on the 22nd day"));
+    QCOMPARE(IncidenceFormatter::recurrenceString(monthDayEvent(-1)), QStringLiteral("Recurs monthly on the Last day"));
+    QCOMPARE(IncidenceFormatter::recurrenceString(monthDayEvent(-3)), QStringLiteral("Recurs monthly on the 3rd Last day"));
+}
+
+void ConcurrentRenderingTest::testConcurrentRendering()
+{
+    // Also creates the identity manager on the main thread, which the
+    // worker threads then only read
+    const QStringList expected = renderAll();
+    QVERIFY(!expected.isEmpty());
+
+    // The worker threads have never rendered anything: their template
+    // managers must pick up the paths set in initTestCase()
+    std::vector<QStringList> results(threadCount * iterations);
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(QThread::create([&results, i]() {
+            for (int j = 0; j < iterations; ++j) {
+                results[i * iterations + j] = renderAll();
+            }
+        }));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads) {
+        QVERIFY(thread->wait());
+    }
+
+    for (const QStringList &result : results) {
+        QCOMPARE(result, expected);
+    }
+}
+
+#include "moc_testconcurrentrendering.cpp"
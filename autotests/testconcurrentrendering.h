@@ -0,0 +1,20 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class ConcurrentRenderingTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testMonthDayRecurrence();
+    void testConcurrentRendering();
+};
@@ -0,0 +1,248 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testheadless.h"
+#include "test_config.h"
+
+#include "formatterproviders_p.h"
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QFile>
+#include <QGuiApplication>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimeZone>
+
+// A plain QCoreApplication, as used by server-side renderers
+QTEST_GUILESS_MAIN(HeadlessTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+namespace
+{
+class TestColorProvider : public IncidenceFormatter::ColorProvider
+{
+public:
+    QString color(ColorRole role) const override
+    {
+        return role == ButtonBackgroundColor ? QStringLiteral("#123456") : ColorProvider::color(role);
+    }
+};
+
+class TestIconProvider : public IncidenceFormatter::IconProvider
+{
+public:
+    QString iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const override
+    {
+        Q_UNUSED(canReturnNull)
+        return QStringLiteral("/icons/%1-%2.png").arg(name).arg(iconSize(sizeOrGroup));
+    }
+};
+
+// Resolves every icon to the same file
+class FileIconProvider : public IncidenceFormatter::IconProvider
+{
+public:
+    explicit FileIconProvider(const QString &path)
+        : mPath(path)
+    {
+    }
+
+    QString iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const override
+    {
+        Q_UNUSED(name)
+        Q_UNUSED(sizeOrGroup)
+        Q_UNUSED(canReturnNull)
+        return mPath;
+    }
+
+private:
+    const QString mPath;
+};
+
+// Resolves the icons of a theme that can be switched
+class ThemeIconProvider : public IncidenceFormatter::IconProvider
+{
+public:
+    QString iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const override
+    {
+        Q_UNUSED(sizeOrGroup)
+        Q_UNUSED(canReturnNull)
+        return QStringLiteral("/%1/%2.png").arg(mTheme, name);
+    }
+
+    void setTheme(const QString &theme, bool notify)
+    {
+        mTheme = theme;
+        if (notify) {
+            iconsChanged();
+        }
+    }
+
+private:
+    QString mTheme = QStringLiteral("first");
+};
+
+QString formatInvitation(const QString &name)
+{
+    QFile file(QStringLiteral(TEST_DATA_DIR "/%1.ical").arg(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+    return IncidenceFormatter::formatICalInvitation(QString::fromUtf8(file.readAll()), calendar, &helper);
+}
+}
+
+void HeadlessTest::initTestCase()
+{
+    QVERIFY(!qobject_cast<QGuiApplication *>(QCoreApplication::instance()));
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void HeadlessTest::cleanup()
+{
+    IncidenceFormatter::setColorProvider(nullptr);
+    IncidenceFormatter::setIconProvider(nullptr);
+    IncidenceFormatter::setIconMode(IncidenceFormatter::IconFilePaths);
+}
+
+void HeadlessTest::testBuiltinProviders()
+{
+    const IncidenceFormatter::ColorProvider *colors = IncidenceFormatter::colorProvider();
+    QCOMPARE(colors->color(IncidenceFormatter::ColorProvider::DiffColor), QStringLiteral("#ff0000"));
+    QCOMPARE(colors->color(IncidenceFormatter::ColorProvider::ButtonBackgroundColor), QStringLiteral("#fcfcfc"));
+
+    const IncidenceFormatter::IconProvider *icons = IncidenceFormatter::iconProvider();
+    QVERIFY(icons->iconPath(QStringLiteral("view-calendar-day"), 3, false).isEmpty());
+    QCOMPARE(icons->iconSize(3), 16);
+    QCOMPARE(icons->iconSize(64), 64);
+}
+
+void HeadlessTest::testInvitation()
+{
+    const QString html = formatInvitation(QStringLiteral("itip-event-request"));
+    QVERIFY(!html.isEmpty());
+    QVERIFY(html.contains(QLatin1StringView("#fcfcfc")));
+    QVERIFY(!html.contains(QLatin1StringView("<img src=\"file://\"")));
+}
+
+void HeadlessTest::testExtensiveDisplay()
+{
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    QVERIFY(format.load(calendar, QStringLiteral(TEST_DATA_DIR "/event-2.ical")));
+    const Incidence::List incidences = calendar->incidences();
+    QCOMPARE(incidences.size(), 1);
+
+    const QString html = IncidenceFormatter::extensiveDisplayStr(calendar, incidences.first());
+    QVERIFY(!html.isEmpty());
+    QVERIFY(!html.contains(QLatin1StringView("/icons/")));
+    QVERIFY(!html.contains(QLatin1StringView("<img")));
+}
+
+void HeadlessTest::testCustomProviders()
+{
+    TestColorProvider colors;
+    TestIconProvider icons;
+    IncidenceFormatter::setColorProvider(&colors);
+    IncidenceFormatter::setIconProvider(&icons);
+    QCOMPARE(IncidenceFormatter::colorProvider(), &colors);
+    QCOMPARE(IncidenceFormatter::iconProvider(), &icons);
+
+    const QString html = formatInvitation(QStringLiteral("itip-event-request"));
+    QVERIFY(html.contains(QLatin1StringView("#123456")));
+    QVERIFY(html.contains(QLatin1StringView("/icons/")));
+
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    QVERIFY(format.load(calendar, QStringLiteral(TEST_DATA_DIR "/event-2.ical")));
+    const QString display = IncidenceFormatter::extensiveDisplayStr(calendar, calendar->incidences().first());
+    QVERIFY(display.contains(QLatin1StringView("/icons/mail-message-new-16.png")));
+}
+
+void HeadlessTest::testIconRevision()
+{
+    ThemeIconProvider icons;
+    const quint64 revision = icons.revision();
+    IncidenceFormatter::setIconProvider(&icons);
+
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    QVERIFY(format.load(calendar, QStringLiteral(TEST_DATA_DIR "/event-2.ical")));
+    const Incidence::Ptr incidence = calendar->incidences().first();
+    QVERIFY(IncidenceFormatter::extensiveDisplayStr(calendar, incidence).contains(QLatin1StringView("/first/mail-message-new.png")));
+
+    // The template keeps the paths of literal icons until the revision changes
+    icons.setTheme(QStringLiteral("second"), false);
+    QVERIFY(IncidenceFormatter::extensiveDisplayStr(calendar, incidence).contains(QLatin1StringView("/first/mail-message-new.png")));
+
+    icons.setTheme(QStringLiteral("second"), true);
+    QVERIFY(icons.revision() != revision);
+    const QString display = IncidenceFormatter::extensiveDisplayStr(calendar, incidence);
+    QVERIFY(display.contains(QLatin1StringView("/second/mail-message-new.png")));
+    QVERIFY(!display.contains(QLatin1StringView("/first/")));
+
+    // Another provider never sees the paths of the previous one
+    TestIconProvider otherIcons;
+    IncidenceFormatter::setIconProvider(&otherIcons);
+    QVERIFY(IncidenceFormatter::extensiveDisplayStr(calendar, incidence).contains(QLatin1StringView("/icons/mail-message-new-16.png")));
+}
+
+void HeadlessTest::testDataUriIcons()
+{
+    const QByteArray svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"16\" height=\"16\"/>";
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath(QStringLiteral("icon.svg")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(svg);
+    file.close();
+
+    QCOMPARE(IncidenceFormatter::iconMode(), IncidenceFormatter::IconFilePaths);
+    const QString dataUri = FormatterProviders::iconDataUri(file.fileName());
+    QCOMPARE(dataUri, QLatin1StringView("data:image/svg+xml;base64,") + QString::fromLatin1(svg.toBase64()));
+
+    // Missing icons are looked for again
+    QFile missing(dir.filePath(QStringLiteral("missing.svg")));
+    QVERIFY(FormatterProviders::iconDataUri(missing.fileName()).isEmpty());
+    QVERIFY(missing.open(QIODevice::WriteOnly));
+    missing.write(svg);
+    missing.close();
+    QCOMPARE(FormatterProviders::iconDataUri(missing.fileName()), dataUri);
+
+    FileIconProvider icons(file.fileName());
+    IncidenceFormatter::setIconProvider(&icons);
+    IncidenceFormatter::setIconMode(IncidenceFormatter::IconDataUris);
+
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    QVERIFY(format.load(calendar, QStringLiteral(TEST_DATA_DIR "/event-2.ical")));
+    const QString display = IncidenceFormatter::extensiveDisplayStr(calendar, calendar->incidences().first());
+    QVERIFY(display.contains(QLatin1StringView("src=\"") + dataUri + QLatin1Char('"')));
+    QVERIFY(!display.contains(QLatin1StringView("file://")));
+
+    // The encoded icon is cached, even once the file is gone
+    QVERIFY(file.remove());
+    QCOMPARE(FormatterProviders::iconDataUri(file.fileName()), dataUri);
+
+    // Until the icons change
+    IncidenceFormatter::setIconProvider(nullptr);
+    QVERIFY(FormatterProviders::iconDataUri(file.fileName()).isEmpty());
+}
+
+#include "moc_testheadless.cpp"
@@ -0,0 +1,25 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class HeadlessTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void testBuiltinProviders();
+    void testInvitation();
+    void testExtensiveDisplay();
+    void testCustomProviders();
+    void testIconRevision();
+    void testDataUriIcons();
+};
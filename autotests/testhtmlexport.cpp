@@ -0,0 +1,212 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testhtmlexport.h"
+#include "test_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "htmlexport.h"
+#include "htmlexportsettings.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/MemoryCalendar>
+#include <KCalendarCore/Todo>
+
+#include <QFile>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_MAIN(HtmlExportTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+static Calendar::Ptr createCalendar(int eventCount, int todoCount)
+{
+    Calendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    for (int i = 0; i < eventCount; ++i) {
+        Event::Ptr event(new Event);
+        event->setSummary(QStringLiteral("Event %1").arg(i));
+        const QDateTime start(QDate(2020, 1, 1 + i % 28), QTime(9 + i % 8, 0), QTimeZone::utc());
+        event->setDtStart(start);
+        event->setDtEnd(start.addSecs(30 * 60));
+        calendar->addEvent(event);
+    }
+    for (int i = 0; i < todoCount; ++i) {
+        Todo::Ptr todo(new Todo);
+        todo->setSummary(QStringLiteral("Todo %1").arg(i));
+        todo->setDtDue(QDateTime(QDate(2020, 1, 10), QTime(12, 0), QTimeZone::utc()));
+        calendar->addTodo(todo);
+    }
+    return calendar;
+}
+
+static QString readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+static void initSettings(HTMLExportSettings &settings)
+{
+    settings.setTitle(QStringLiteral("Team calendar"));
+    settings.setDateStart(QDate(2020, 1, 1));
+    settings.setDateEnd(QDate(2020, 1, 31));
+}
+
+void HtmlExportTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void HtmlExportTest::testSingleFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    HTMLExportSettings settings;
+    initSettings(settings);
+    settings.setWeekView(true);
+
+    HtmlExport exporter(createCalendar(10, 3), &settings);
+    const QString fileName = dir.filePath(QStringLiteral("calendar.html"));
+    QVERIFY(exporter.save(fileName));
+    QCOMPARE(exporter.outputFiles(), QStringList{fileName});
+
+    const QString html = readFile(fileName);
+    QVERIFY(html.startsWith(QLatin1StringView("<!DOCTYPE html>")));
+    QVERIFY(html.contains(QLatin1StringView("Team calendar")));
+    QVERIFY(html.contains(QLatin1StringView("January 2020")));
+    QVERIFY(html.contains(QLatin1StringView("Event 9")));
+    QVERIFY(html.contains(QLatin1StringView("Todo 2")));
+    QVERIFY(!html.contains(QLatin1StringView("Template parsing error")));
+    QVERIFY(!html.contains(QLatin1StringView("Template rendering error")));
+    QVERIFY(html.trimmed().endsWith(QLatin1StringView("</html>")));
+}
+
+void HtmlExportTest::testSplitFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    HTMLExportSettings settings;
+    initSettings(settings);
+    settings.setMonthView(false);
+    settings.setWeekView(true);
+    settings.setTodoView(false);
+    settings.setMaxIncidencesPerFile(10);
+    settings.setOutputFile(dir.filePath(QStringLiteral("calendar.html")));
+
+    HtmlExport exporter(createCalendar(28, 0), &settings);
+    QVERIFY(exporter.save());
+
+    // 28 events, one per day; a full week has 7 and two of them exceed the
+    // 10 events per file, so full weeks get a file each
+    const QStringList files = exporter.outputFiles();
+    QVERIFY(files.count() > 1);
+    QCOMPARE(files.at(1), dir.filePath(QStringLiteral("calendar-2.html")));
+
+    int events = 0;
+    for (int i = 0; i < files.count(); ++i) {
+        const QString html = readFile(files.at(i));
+        QVERIFY(html.trimmed().endsWith(QLatin1StringView("</html>")));
+        QCOMPARE(html.contains(QLatin1StringView("href=\"calendar-%1.html\"").arg(i + 2)), i < files.count() - 1);
+        int fileEvents = 0;
+        for (int e = 0; e < 28; ++e) {
+            if (html.contains(QStringLiteral("Event %1<").arg(e))) {
+                ++fileEvents;
+            }
+        }
+        QVERIFY(fileEvents <= 10);
+        events += fileEvents;
+    }
+    QCOMPARE(events, 28);
+}
+
+void HtmlExportTest::testRecurringAndMultiDayEvents()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    Calendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    Event::Ptr weekly(new Event);
+    weekly->setSummary(QStringLiteral("Weekly review"));
+    weekly->setDtStart(QDateTime(QDate(2020, 1, 1), QTime(0, 0)));
+    weekly->setDtEnd(weekly->dtStart());
+    weekly->setAllDay(true);
+    weekly->recurrence()->setWeekly(1);
+    calendar->addEvent(weekly);
+
+    Event::Ptr conference(new Event);
+    conference->setSummary(QStringLiteral("Conference"));
+    conference->setDtStart(QDateTime(QDate(2020, 1, 10), QTime(0, 0)));
+    conference->setDtEnd(QDateTime(QDate(2020, 1, 12), QTime(0, 0)));
+    conference->setAllDay(true);
+    calendar->addEvent(conference);
+
+    HTMLExportSettings settings;
+    initSettings(settings);
+    settings.setMonthView(false);
+    settings.setWeekView(true);
+    settings.setTodoView(false);
+
+    HtmlExport exporter(calendar, &settings);
+    const QString fileName = dir.filePath(QStringLiteral("calendar.html"));
+    QVERIFY(exporter.save(fileName));
+
+    // Every occurrence and every day of the conference is listed once
+    const QString html = readFile(fileName);
+    QCOMPARE(html.count(QLatin1StringView("<b>Weekly review</b>")), 5);
+    QCOMPARE(html.count(QLatin1StringView("<b>Conference</b>")), 3);
+}
+
+void HtmlExportTest::testExcludePrivate()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    Calendar::Ptr calendar = createCalendar(1, 0);
+    Event::Ptr secret(new Event);
+    secret->setSummary(QStringLiteral("Secret meeting"));
+    secret->setSecrecy(Incidence::SecrecyPrivate);
+    secret->setDtStart(QDateTime(QDate(2020, 1, 2), QTime(10, 0), QTimeZone::utc()));
+    secret->setDtEnd(QDateTime(QDate(2020, 1, 2), QTime(11, 0), QTimeZone::utc()));
+    calendar->addEvent(secret);
+
+    HTMLExportSettings settings;
+    initSettings(settings);
+
+    HtmlExport exporter(calendar, &settings);
+    const QString fileName = dir.filePath(QStringLiteral("calendar.html"));
+    QVERIFY(exporter.save(fileName));
+    QVERIFY(!readFile(fileName).contains(QLatin1StringView("Secret meeting")));
+
+    settings.setExcludePrivate(false);
+    QVERIFY(exporter.save(fileName));
+    QVERIFY(readFile(fileName).contains(QLatin1StringView("Secret meeting")));
+}
+
+void HtmlExportTest::testInvalidOutputFile()
+{
+    HTMLExportSettings settings;
+    initSettings(settings);
+
+    HtmlExport exporter(createCalendar(1, 0), &settings);
+    QVERIFY(!exporter.save());
+    QVERIFY(!exporter.save(QStringLiteral("/nonexistent/directory/calendar.html")));
+    QVERIFY(exporter.outputFiles().isEmpty());
+}
+
+#include "moc_testhtmlexport.cpp"
@@ -0,0 +1,23 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class HtmlExportTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testSingleFile();
+    void testSplitFiles();
+    void testRecurringAndMultiDayEvents();
+    void testExcludePrivate();
+    void testInvalidOutputFile();
+};
@@ -0,0 +1,74 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testhtmltext.h"
+
+#include "htmltext_p.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(HtmlTextTest)
+
+using namespace KCalUtils;
+
+Q_DECLARE_METATYPE(KCalUtils::HtmlText::Options)
+
+void HtmlTextTest::testLinesToHtml_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("tag");
+    QTest::addColumn<HtmlText::Options>("options");
+    QTest::addColumn<QString>("expected");
+
+    const HtmlText::Options none = HtmlText::NoOptions;
+    QTest::newRow("empty") << QString() << QString() << none << QString();
+    QTest::newRow("empty tag") << QString() << QStringLiteral("p") << none << QStringLiteral("<p></p>");
+    QTest::newRow("single line") << QStringLiteral("a <b>c</b>") << QStringLiteral("p") << none << QStringLiteral("<p>a <b>c</b></p>");
+    QTest::newRow("lines") << QStringLiteral("a\nb\nc") << QString() << none << QStringLiteral("a<br>b<br>c");
+    QTest::newRow("trailing break") << QStringLiteral("a\nb") << QStringLiteral("p") << HtmlText::Options(HtmlText::TrailingBreak)
+                                    << QStringLiteral("<p>a<br>b<br></p>");
+    QTest::newRow("trailing break, single line") << QStringLiteral("a") << QStringLiteral("p") << HtmlText::Options(HtmlText::TrailingBreak)
+                                                 << QStringLiteral("<p>a</p>");
+    QTest::newRow("trailing break, final newline") << QStringLiteral("a\n") << QStringLiteral("p") << HtmlText::Options(HtmlText::TrailingBreak)
+                                                   << QStringLiteral("<p>a<br><br></p>");
+    QTest::newRow("empty lines") << QStringLiteral("\n\n") << QString() << none << QStringLiteral("<br><br>");
+    QTest::newRow("escape") << QStringLiteral("<a href=\"x\">&</a>\n'") << QString() << HtmlText::Options(HtmlText::Escape)
+                            << QStringLiteral("&lt;a href=&quot;x&quot;&gt;&amp;&lt;/a&gt;<br>'");
+}
+
+void HtmlTextTest::testLinesToHtml()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, tag);
+    QFETCH(HtmlText::Options, options);
+    QFETCH(QString, expected);
+
+    const QByteArray latin1Tag = tag.toLatin1();
+    QCOMPARE(HtmlText::linesToHtml(text, QLatin1StringView(latin1Tag), options), expected);
+
+    // Escaping must match what Qt does
+    if (options & HtmlText::Escape) {
+        QCOMPARE(HtmlText::linesToHtml(text, {}, options), text.toHtmlEscaped().replace(QLatin1Char('\n'), QLatin1StringView("<br>")));
+    }
+}
+
+void HtmlTextTest::testManyLines()
+{
+    const int lines = 50000;
+    QString text;
+    QString expected = QStringLiteral("<p>");
+    for (int i = 0; i < lines; ++i) {
+        const QString line = QStringLiteral("line %1").arg(i);
+        text += line + QLatin1Char('\n');
+        expected += line + QLatin1StringView("<br>");
+    }
+    text.chop(1);
+    expected += QLatin1StringView("</p>");
+
+    QCOMPARE(HtmlText::linesToHtml(text, QLatin1StringView("p"), HtmlText::TrailingBreak), expected);
+}
+
+#include "moc_testhtmltext.cpp"
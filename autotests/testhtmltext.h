@@ -0,0 +1,19 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class HtmlTextTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testLinesToHtml_data();
+    void testLinesToHtml();
+    void testManyLines();
+};
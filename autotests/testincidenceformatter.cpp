@@ -11,6 +11,7 @@
 
 #include "grantleetemplatemanager_p.h"
 #include "incidenceformatter.h"
+#include "qtresourcetemplateloader.h"
 
 #include <KCalendarCore/Event>
 #include <KCalendarCore/FreeBusy>
@@ -22,13 +23,17 @@
 #include <KLocalizedString>
 
 #include <QDebug>
+#include <QFile>
 #include <QIcon>
 #include <QLocale>
 #include <QProcess>
 #include <QRegularExpression>
 #include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTest>
 #include <QTimeZone>
+
+#include <typeinfo>
 QTEST_MAIN(IncidenceFormatterTest)
 #ifndef Q_OS_WIN
 void initLocale()
@@ -65,6 +70,13 @@ void IncidenceFormatterTest::initTestCase()
     btnHl = palette.shadow().color().name();
 }
 
+void IncidenceFormatterTest::testGuiProviders()
+{
+    // With a QGuiApplication, the providers come from the GUI providers plugin
+    QVERIFY(typeid(*IncidenceFormatter::colorProvider()) != typeid(IncidenceFormatter::ColorProvider));
+    QVERIFY(typeid(*IncidenceFormatter::iconProvider()) != typeid(IncidenceFormatter::IconProvider));
+}
+
 void IncidenceFormatterTest::testRecurrenceString()
 {
     // TEST: A daily recurrence with date exclusions //
@@ -231,6 +243,26 @@ void IncidenceFormatterTest::cleanup(const QString &name)
     QFile::remove(QStringLiteral(TEST_DATA_DIR "/%1.out.html").arg(name));
 }
 
+void IncidenceFormatterTest::testLocaleFormats()
+{
+    const QDateTime dateTime(QDate(2024, 3, 5), QTime(14, 30));
+    const QLocale defaultLocale;
+
+    // Same output as the locale itself, for the system locale whose
+    // platform backend may differ from its format strings too
+    for (const QLocale &locale : {QLocale::system(), QLocale(QStringLiteral("de_DE")), QLocale(QStringLiteral("C"))}) {
+        QLocale::setDefault(locale);
+        for (bool shortfmt : {false, true}) {
+            const QLocale::FormatType format = shortfmt ? QLocale::ShortFormat : QLocale::LongFormat;
+            QCOMPARE(IncidenceFormatter::dateToString(dateTime.date(), shortfmt), locale.toString(dateTime.date(), format));
+            QCOMPARE(IncidenceFormatter::timeToString(dateTime.time(), shortfmt), locale.toString(dateTime.time(), format));
+            QCOMPARE(IncidenceFormatter::dateTimeToString(dateTime, false, shortfmt), locale.toString(dateTime, format));
+        }
+    }
+
+    QLocale::setDefault(defaultLocale);
+}
+
 void IncidenceFormatterTest::testErrorTemplate()
 {
     GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_DATA_DIR));
@@ -245,6 +277,59 @@ void IncidenceFormatterTest::testErrorTemplate()
     QCOMPARE(html, expected);
 }
 
+void IncidenceFormatterTest::testTemplateFileCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath(QStringLiteral("cached.html")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("first");
+    file.close();
+    QVERIFY(QFile::copy(QStringLiteral(TEST_DATA_DIR "/broken-template.html"), dir.filePath(QStringLiteral("broken-template.html"))));
+
+    GrantleeTemplateManager *manager = GrantleeTemplateManager::instance();
+    manager->setTemplatePath(dir.path());
+
+    QCOMPARE(manager->render(QStringLiteral("cached.html"), QVariantHash()), QStringLiteral("first"));
+    const IncidenceFormatter::Statistics before = IncidenceFormatter::statistics();
+    QCOMPARE(manager->render(QStringLiteral("cached.html"), QVariantHash()), QStringLiteral("first"));
+    const IncidenceFormatter::Statistics after = IncidenceFormatter::statistics();
+    QCOMPARE(after.templateCacheMisses(), before.templateCacheMisses());
+    QCOMPARE(after.templateCacheHits(), before.templateCacheHits() + 1);
+
+    // Modified templates are parsed again
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("second");
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(3600), QFileDevice::FileModificationTime));
+    file.close();
+    // Files are only checked again once the revalidation interval passed
+    QCOMPARE(manager->render(QStringLiteral("cached.html"), QVariantHash()), QStringLiteral("first"));
+    QTest::qSleep(QtResourceTemplateLoader::revalidateInterval + 100);
+    QCOMPARE(manager->render(QStringLiteral("cached.html"), QVariantHash()), QStringLiteral("second"));
+
+    // Removed templates are not found anymore, added ones are found
+    QVERIFY(file.remove());
+    QTest::qSleep(QtResourceTemplateLoader::revalidateInterval + 100);
+    QVERIFY(manager->render(QStringLiteral("cached.html"), QVariantHash()).isEmpty());
+    QVERIFY(manager->render(QStringLiteral("cached.html"), QVariantHash()).isEmpty());
+    // Also lets the directory get a new modification time, whatever the
+    // file system
+    QTest::qSleep(QtResourceTemplateLoader::revalidateInterval + 100);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("third");
+    file.close();
+    QCOMPARE(manager->render(QStringLiteral("cached.html"), QVariantHash()), QStringLiteral("third"));
+
+    // Broken and missing templates give the same result every time
+    const QString error = manager->render(QStringLiteral("broken-template.html"), QVariantHash());
+    QVERIFY(error.startsWith(QLatin1StringView("<h1>Template parsing error</h1>")));
+    QCOMPARE(manager->render(QStringLiteral("broken-template.html"), QVariantHash()), error);
+    QVERIFY(manager->render(QStringLiteral("missing.html"), QVariantHash()).isEmpty());
+    QVERIFY(manager->render(QStringLiteral("missing.html"), QVariantHash()).isEmpty());
+
+    manager->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+}
+
 void IncidenceFormatterTest::testDisplayViewFormatEvent_data()
 {
     QTest::addColumn<QString>("name");
@@ -415,4 +500,32 @@ void IncidenceFormatterTest::testFormatIcalInvitation()
     cleanup(name);
 }
 
+void IncidenceFormatterTest::testAttendeeFragments()
+{
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    Event::Ptr event(new Event);
+    event->setSummary(QStringLiteral("Weekly meeting"));
+    event->setDtStart(QDateTime(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc()));
+    event->setDtEnd(event->dtStart().addSecs(3600));
+    event->setOrganizer(Person(QStringLiteral("Organizer"), QStringLiteral("organizer@example.com")));
+    for (int i = 0; i < 50; ++i) {
+        Attendee attendee(QStringLiteral("Attendee %1").arg(i % 5), QStringLiteral("attendee%1@example.com").arg(i % 5), true, Attendee::Accepted);
+        event->addAttendee(attendee);
+    }
+
+    // The rows of the same people are rendered once and reused
+    const QRegularExpression attendee3(QStringLiteral(">\\s*Attendee 3\\s*</a>"));
+    const QString html = IncidenceFormatter::extensiveDisplayStr(calendar, event);
+    QCOMPARE(html.count(attendee3), 10);
+    QCOMPARE(IncidenceFormatter::extensiveDisplayStr(calendar, event), html);
+
+    // Changed attendees are rendered again
+    Attendee::List attendees = event->attendees();
+    attendees[3].setName(QStringLiteral("Renamed"));
+    event->setAttendees(attendees);
+    const QString changed = IncidenceFormatter::extensiveDisplayStr(calendar, event);
+    QCOMPARE(changed.count(attendee3), 9);
+    QCOMPARE(changed.count(QRegularExpression(QStringLiteral(">\\s*Renamed\\s*</a>"))), 1);
+}
+
 #include "moc_testincidenceformatter.cpp"
@@ -26,9 +26,12 @@ private:
 private Q_SLOTS:
     void initTestCase();
 
+    void testGuiProviders();
     void testRecurrenceString();
+    void testLocaleFormats();
 
     void testErrorTemplate();
+    void testTemplateFileCache();
 
     void testDisplayViewFormatEvent_data();
     void testDisplayViewFormatEvent();
@@ -44,4 +47,6 @@ private Q_SLOTS:
 
     void testFormatIcalInvitation_data();
     void testFormatIcalInvitation();
+
+    void testAttendeeFragments();
 };
@@ -0,0 +1,88 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testinvitationattachments.h"
+#include "test_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTimeZone>
+
+#include <iterator>
+
+QTEST_MAIN(InvitationAttachmentsTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+static const int attachmentCount = 100;
+
+static QString createInvitation(int count)
+{
+    static const char *const mimeTypes[] = {"application/pdf",
+                                            "application/vnd.oasis.opendocument.text",
+                                            "application/vnd.oasis.opendocument.spreadsheet",
+                                            "image/png",
+                                            "text/plain"};
+
+    Event::Ptr event(new Event);
+    event->setUid(QStringLiteral("attachments-benchmark"));
+    event->setSummary(QStringLiteral("Document review"));
+    event->setOrganizer(Person(QStringLiteral("Organizer"), QStringLiteral("organizer@example.com")));
+    const QDateTime start(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc());
+    event->setDtStart(start);
+    event->setDtEnd(start.addSecs(3600));
+    for (int i = 0; i < count; ++i) {
+        Attachment attachment(QStringLiteral("https://example.com/documents/%1").arg(i), QString::fromLatin1(mimeTypes[i % std::size(mimeTypes)]));
+        attachment.setLabel(QStringLiteral("document-%1").arg(i));
+        event->addAttachment(attachment);
+    }
+
+    ICalFormat format;
+    return format.createScheduleMessage(event, iTIPRequest);
+}
+
+void InvitationAttachmentsTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void InvitationAttachmentsTest::testManyAttachments()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+
+    const QString html = IncidenceFormatter::formatICalInvitation(createInvitation(attachmentCount), calendar, &helper);
+    QVERIFY(!html.isEmpty());
+    for (int i = 0; i < attachmentCount; ++i) {
+        QVERIFY(html.contains(QStringLiteral(">document-%1<").arg(i)));
+    }
+}
+
+void InvitationAttachmentsTest::benchmarkManyAttachments()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+    const QString invitation = createInvitation(attachmentCount);
+
+    QBENCHMARK {
+        const QString html = IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+        Q_UNUSED(html)
+    }
+}
+
+#include "moc_testinvitationattachments.cpp"
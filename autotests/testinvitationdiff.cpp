@@ -0,0 +1,129 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testinvitationdiff.h"
+
+#include "invitationdiff_p.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/Todo>
+
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(InvitationDiffTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+static Event::Ptr createEvent()
+{
+    Event::Ptr event(new Event);
+    event->setUid(QStringLiteral("diff-test"));
+    event->setSummary(QStringLiteral("Meeting"));
+    event->setLocation(QStringLiteral("Room 1"));
+    event->setDescription(QStringLiteral("Agenda"));
+    const QDateTime start(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc());
+    event->setDtStart(start);
+    event->setDtEnd(start.addSecs(3600));
+    event->addAttendee(Attendee(QStringLiteral("Alice"), QStringLiteral("alice@example.com")));
+    event->addAttendee(Attendee(QStringLiteral("Bob"), QStringLiteral("bob@example.com")));
+    return event;
+}
+
+void InvitationDiffTest::testNoOldIncidence()
+{
+    const InvitationDiff diff(createEvent(), Incidence::Ptr());
+    QVERIFY(!diff.hasChanges());
+    QVERIFY(diff.attendeeChanges().isEmpty());
+}
+
+void InvitationDiffTest::testUnchanged()
+{
+    const Event::Ptr event = createEvent();
+    const InvitationDiff diff(event, Event::Ptr(event->clone()));
+    QVERIFY(!diff.hasChanges());
+    QCOMPARE(diff.changedFields(), InvitationDiff::Fields(InvitationDiff::NoField));
+}
+
+void InvitationDiffTest::testFields()
+{
+    const Event::Ptr oldEvent = createEvent();
+    const Event::Ptr event(oldEvent->clone());
+    event->setSummary(QStringLiteral("Planning"));
+    event->setDtEnd(event->dtEnd().addSecs(1800));
+    event->setCategories(QStringList{QStringLiteral("Work")});
+
+    const InvitationDiff diff(event, oldEvent);
+    QVERIFY(diff.hasChanges());
+    QCOMPARE(diff.changedFields(), InvitationDiff::Summary | InvitationDiff::DtEnd | InvitationDiff::Categories);
+    QVERIFY(diff.isChanged(InvitationDiff::Summary | InvitationDiff::Location));
+    QVERIFY(!diff.isChanged(InvitationDiff::Location | InvitationDiff::DtStart));
+}
+
+void InvitationDiffTest::testAttendees()
+{
+    const Event::Ptr oldEvent = createEvent();
+    const Event::Ptr event(oldEvent->clone());
+
+    Attendee::List attendees;
+    Attendee alice(QStringLiteral("Alice"), QStringLiteral("ALICE@example.com"));
+    alice.setStatus(Attendee::Accepted);
+    attendees << alice << Attendee(QStringLiteral("Carol"), QStringLiteral("carol@example.com"));
+    event->setAttendees(attendees);
+
+    const InvitationDiff diff(event, oldEvent);
+    QCOMPARE(diff.changedFields(), InvitationDiff::Fields(InvitationDiff::Attendees));
+
+    const auto changes = diff.attendeeChanges();
+    QCOMPARE(changes.count(), 3);
+    QCOMPARE(changes.at(0).type, InvitationDiff::AttendeeChange::StatusChanged);
+    QCOMPARE(changes.at(0).attendee.name(), QStringLiteral("Alice"));
+    QCOMPARE(changes.at(0).oldStatus, Attendee::NeedsAction);
+    QCOMPARE(changes.at(1).type, InvitationDiff::AttendeeChange::Added);
+    QCOMPARE(changes.at(1).attendee.name(), QStringLiteral("Carol"));
+    QCOMPARE(changes.at(2).type, InvitationDiff::AttendeeChange::Removed);
+    QCOMPARE(changes.at(2).attendee.name(), QStringLiteral("Bob"));
+}
+
+void InvitationDiffTest::testRecurrence()
+{
+    const Event::Ptr oldEvent = createEvent();
+    oldEvent->recurrence()->setDaily(1);
+    const Event::Ptr event(oldEvent->clone());
+    QVERIFY(!InvitationDiff(event, oldEvent).hasChanges());
+
+    event->recurrence()->setDuration(5);
+    QCOMPARE(InvitationDiff(event, oldEvent).changedFields(), InvitationDiff::Fields(InvitationDiff::Recurrence));
+
+    event->recurrence()->clear();
+    QCOMPARE(InvitationDiff(event, oldEvent).changedFields(), InvitationDiff::Fields(InvitationDiff::Recurrence));
+}
+
+void InvitationDiffTest::testAlarms()
+{
+    const Event::Ptr oldEvent = createEvent();
+    const Event::Ptr event(oldEvent->clone());
+    Alarm::Ptr alarm = event->newAlarm();
+    alarm->setStartOffset(Duration(-600));
+    alarm->setEnabled(true);
+
+    QCOMPARE(InvitationDiff(event, oldEvent).changedFields(), InvitationDiff::Fields(InvitationDiff::Alarms));
+}
+
+void InvitationDiffTest::testTodoPercentComplete()
+{
+    Todo::Ptr oldTodo(new Todo);
+    oldTodo->setSummary(QStringLiteral("Write report"));
+    oldTodo->setDtDue(QDateTime(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc()));
+    const Todo::Ptr todo(oldTodo->clone());
+    todo->setPercentComplete(50);
+    todo->setDtDue(oldTodo->dtDue().addDays(1));
+
+    QCOMPARE(InvitationDiff(todo, oldTodo).changedFields(), InvitationDiff::PercentComplete | InvitationDiff::DtEnd);
+}
+
+#include "moc_testinvitationdiff.cpp"
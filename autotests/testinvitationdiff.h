@@ -0,0 +1,23 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class InvitationDiffTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testNoOldIncidence();
+    void testUnchanged();
+    void testFields();
+    void testAttendees();
+    void testRecurrence();
+    void testAlarms();
+    void testTodoPercentComplete();
+};
@@ -0,0 +1,80 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testki18nlocalizer.h"
+
+#include "grantleeki18nlocalizer_p.h"
+#include "incidenceformatter.h"
+
+#include <KLocalizedString>
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(Ki18nLocalizerTest)
+
+using namespace KCalUtils;
+
+// Nothing else in this test fills a cache of the library, so this is the
+// memory held by the localizers alive
+static quint64 cacheMemory()
+{
+    return IncidenceFormatter::statistics().cacheMemory();
+}
+
+void Ki18nLocalizerTest::testMessages()
+{
+    const quint64 before = cacheMemory();
+    {
+        const GrantleeKi18nLocalizer localizer;
+        QCOMPARE(localizer.localizeString(QStringLiteral("Organizer"), {}), QStringLiteral("Organizer"));
+        QCOMPARE(localizer.localizeContextString(QStringLiteral("Location"), QStringLiteral("event location"), {}), QStringLiteral("Location"));
+        const quint64 cached = cacheMemory();
+        QVERIFY(cached > before);
+
+        // Looked up again, the messages come from the cache
+        QCOMPARE(localizer.localizeString(QStringLiteral("Organizer"), {}), QStringLiteral("Organizer"));
+        QCOMPARE(localizer.localizeContextString(QStringLiteral("Location"), QStringLiteral("event location"), {}), QStringLiteral("Location"));
+        QCOMPARE(cacheMemory(), cached);
+    }
+    QCOMPARE(cacheMemory(), before);
+}
+
+void Ki18nLocalizerTest::testArguments()
+{
+    const GrantleeKi18nLocalizer localizer;
+    QCOMPARE(localizer.localizeString(QStringLiteral("Invited by %1"), {QStringLiteral("Alice")}), QStringLiteral("Invited by Alice"));
+    QCOMPARE(localizer.localizeString(QStringLiteral("Invited by %1"), {QStringLiteral("Bob")}), QStringLiteral("Invited by Bob"));
+
+    const QString singular = QStringLiteral("1 attendee");
+    const QString plural = QStringLiteral("%1 attendees");
+    QCOMPARE(localizer.localizePluralString(singular, plural, {1}), QStringLiteral("1 attendee"));
+    QCOMPARE(localizer.localizePluralString(singular, plural, {5}), QStringLiteral("5 attendees"));
+    QCOMPARE(localizer.localizePluralContextString(singular, plural, QStringLiteral("meeting"), {7}), QStringLiteral("7 attendees"));
+}
+
+void Ki18nLocalizerTest::testLanguageChange()
+{
+    const QStringList languages = KLocalizedString::languages();
+    const quint64 before = cacheMemory();
+    const GrantleeKi18nLocalizer localizer;
+    QCOMPARE(localizer.localizeString(QStringLiteral("Organizer"), {}), QStringLiteral("Organizer"));
+    const quint64 oneMessage = cacheMemory() - before;
+    QVERIFY(oneMessage > 0);
+    QCOMPARE(localizer.localizeString(QStringLiteral("Attendees"), {}), QStringLiteral("Attendees"));
+    QVERIFY(cacheMemory() - before > oneMessage);
+
+    // The cached messages are dropped with the old languages, only the one
+    // looked up since then is cached
+    KLocalizedString::setLanguages({QStringLiteral("de")});
+    QCOMPARE(localizer.localizeString(QStringLiteral("Organizer"), {}), QStringLiteral("Organizer"));
+    QCOMPARE(cacheMemory() - before, oneMessage);
+
+    KLocalizedString::setLanguages(languages);
+    QCOMPARE(localizer.localizeString(QStringLiteral("Organizer"), {}), QStringLiteral("Organizer"));
+    QCOMPARE(cacheMemory() - before, oneMessage);
+}
+
+#include "moc_testki18nlocalizer.cpp"
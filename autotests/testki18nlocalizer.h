@@ -0,0 +1,19 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class Ki18nLocalizerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testMessages();
+    void testArguments();
+    void testLanguageChange();
+};
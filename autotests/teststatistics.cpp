@@ -0,0 +1,225 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "teststatistics.h"
+#include "test_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QFile>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_MAIN(StatisticsTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+using Statistics = IncidenceFormatter::Statistics;
+
+namespace
+{
+// Counts the allocations reported through allocate() and release()
+class FakeProbe : public IncidenceFormatter::AllocationProbe
+{
+public:
+    void allocate(qint64 size)
+    {
+        ++mAllocations;
+        mAllocatedBytes += size;
+        mLiveBytes += size;
+        mPeakLiveBytes = qMax(mPeakLiveBytes, mLiveBytes);
+    }
+
+    void release(qint64 size)
+    {
+        mLiveBytes -= size;
+    }
+
+    quint64 allocations() const override
+    {
+        return mAllocations;
+    }
+
+    quint64 allocatedBytes() const override
+    {
+        return mAllocatedBytes;
+    }
+
+    qint64 liveBytes() const override
+    {
+        return mLiveBytes;
+    }
+
+    qint64 peakLiveBytes() const override
+    {
+        return mPeakLiveBytes;
+    }
+
+    void resetPeak() override
+    {
+        mPeakLiveBytes = mLiveBytes;
+    }
+
+private:
+    quint64 mAllocations = 0;
+    quint64 mAllocatedBytes = 0;
+    qint64 mLiveBytes = 0;
+    qint64 mPeakLiveBytes = 0;
+};
+
+// Pretends that every link of an invitation temporarily takes 100 bytes
+class AllocatingHelper : public InvitationFormatterHelper
+{
+public:
+    explicit AllocatingHelper(FakeProbe *probe)
+        : mProbe(probe)
+    {
+    }
+
+    QString generateLinkURL(const QString &id) override
+    {
+        mProbe->allocate(100);
+        mProbe->release(100);
+        return InvitationFormatterHelper::generateLinkURL(id);
+    }
+
+private:
+    FakeProbe *const mProbe;
+};
+}
+
+void StatisticsTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void StatisticsTest::testInvitationCounters()
+{
+    QFile file(QStringLiteral(TEST_DATA_DIR "/itip-event-request.ical"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QString invitation = QString::fromUtf8(file.readAll());
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+
+    IncidenceFormatter::resetStatistics();
+    const QString first = IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    const Statistics afterFirst = IncidenceFormatter::statistics();
+    const QString second = IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    const Statistics afterSecond = IncidenceFormatter::statistics();
+    QVERIFY(!first.isEmpty());
+    QCOMPARE(second, first);
+
+    QCOMPARE(afterSecond.calls(Statistics::Invitation), quint64(2));
+    QCOMPARE(afterSecond.calls(Statistics::InvitationNoHtml), quint64(0));
+    QCOMPARE(afterSecond.bytesProduced(Statistics::Invitation), quint64(2 * first.size() * sizeof(QChar)));
+    QCOMPARE(afterSecond.invitationParses(), quint64(2));
+    QVERIFY(afterSecond.callNanoseconds(Statistics::Invitation) > 0);
+    QVERIFY(afterSecond.phaseNanoseconds(Statistics::ParsePhase) > 0);
+    QVERIFY(afterSecond.phaseNanoseconds(Statistics::RenderPhase) > 0);
+
+    // The second rendering reuses the parsed template
+    QVERIFY(afterFirst.templateCacheMisses() > 0);
+    QCOMPARE(afterSecond.templateCacheMisses(), afterFirst.templateCacheMisses());
+    QVERIFY(afterSecond.templateCacheHits() > afterFirst.templateCacheHits());
+    QVERIFY(afterSecond.cacheMemory() > 0);
+}
+
+void StatisticsTest::testDisplayCounters()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    Event::Ptr event(new Event);
+    event->setSummary(QStringLiteral("Counted"));
+    event->setDtStart(QDateTime(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc()));
+
+    IncidenceFormatter::resetStatistics();
+    const QString display = IncidenceFormatter::extensiveDisplayStr(calendar, event);
+    const QString toolTip = IncidenceFormatter::toolTipStr(QString(), event);
+    const QString mailBody = IncidenceFormatter::mailBodyStr(event);
+    (void)IncidenceFormatter::toolTipStr(QString(), IncidenceBase::Ptr());
+
+    const Statistics statistics = IncidenceFormatter::statistics();
+    QCOMPARE(statistics.calls(Statistics::ExtensiveDisplay), quint64(1));
+    QCOMPARE(statistics.calls(Statistics::ToolTip), quint64(2));
+    QCOMPARE(statistics.calls(Statistics::MailBody), quint64(1));
+    QCOMPARE(statistics.bytesProduced(Statistics::ExtensiveDisplay), quint64(display.size() * sizeof(QChar)));
+    QCOMPARE(statistics.bytesProduced(Statistics::ToolTip), quint64(toolTip.size() * sizeof(QChar)));
+    QCOMPARE(statistics.bytesProduced(Statistics::MailBody), quint64(mailBody.size() * sizeof(QChar)));
+    QCOMPARE(statistics.invitationParses(), quint64(0));
+}
+
+void StatisticsTest::testReset()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    Event::Ptr event(new Event);
+    event->setSummary(QStringLiteral("Reset"));
+    event->setDtStart(QDateTime(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc()));
+    QVERIFY(!IncidenceFormatter::extensiveDisplayStr(calendar, event).isEmpty());
+
+    const quint64 cacheMemory = IncidenceFormatter::statistics().cacheMemory();
+    IncidenceFormatter::resetStatistics();
+
+    const Statistics statistics = IncidenceFormatter::statistics();
+    for (int i = 0; i < Statistics::EntryPointCount; ++i) {
+        const auto entryPoint = static_cast<Statistics::EntryPoint>(i);
+        QCOMPARE(statistics.calls(entryPoint), quint64(0));
+        QCOMPARE(statistics.callNanoseconds(entryPoint), quint64(0));
+        QCOMPARE(statistics.bytesProduced(entryPoint), quint64(0));
+    }
+    for (int i = 0; i < Statistics::PhaseCount; ++i) {
+        QCOMPARE(statistics.phaseNanoseconds(static_cast<Statistics::Phase>(i)), quint64(0));
+    }
+    // Out of range values have no counters
+    QCOMPARE(statistics.calls(Statistics::EntryPointCount), quint64(0));
+    QCOMPARE(statistics.phaseNanoseconds(Statistics::PhaseCount), quint64(0));
+    QCOMPARE(statistics.templateCacheHits(), quint64(0));
+    QCOMPARE(statistics.templateCacheMisses(), quint64(0));
+    // Cache memory is a current value, not a counter
+    QCOMPARE(statistics.cacheMemory(), cacheMemory);
+}
+
+void StatisticsTest::testAllocationProbe()
+{
+    QFile file(QStringLiteral(TEST_DATA_DIR "/itip-event-request.ical"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QString invitation = QString::fromUtf8(file.readAll());
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    FakeProbe probe;
+    AllocatingHelper helper(&probe);
+
+    // Nothing is accounted without a probe
+    IncidenceFormatter::resetStatistics();
+    QVERIFY(!IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper).isEmpty());
+    QCOMPARE(IncidenceFormatter::statistics().allocations(Statistics::Invitation), quint64(0));
+    QVERIFY(probe.allocations() > 0);
+
+    IncidenceFormatter::resetStatistics();
+    const quint64 allocationsBefore = probe.allocations();
+    IncidenceFormatter::setAllocationProbe(&probe);
+    QVERIFY(!IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper).isEmpty());
+    QVERIFY(!IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper).isEmpty());
+    IncidenceFormatter::setAllocationProbe(nullptr);
+
+    const Statistics statistics = IncidenceFormatter::statistics();
+    const quint64 allocations = probe.allocations() - allocationsBefore;
+    QVERIFY(allocations > 0);
+    QCOMPARE(statistics.allocations(Statistics::Invitation), allocations);
+    QCOMPARE(statistics.allocatedBytes(Statistics::Invitation), allocations * 100);
+    QCOMPARE(statistics.peakBytes(Statistics::Invitation), quint64(100));
+    QCOMPARE(statistics.allocations(Statistics::ExtensiveDisplay), quint64(0));
+}
+
+#include "moc_teststatistics.cpp"
@@ -0,0 +1,137 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testtracing.h"
+#include "test_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+#include "tracing.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_MAIN(TracingTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+// Returns the names of the recorded spans, or an empty list if the trace is invalid
+static QStringList spanNames()
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(Tracing::toChromeTrace(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        return {};
+    }
+    QStringList names;
+    const QJsonArray events = document.object().value(QLatin1StringView("traceEvents")).toArray();
+    for (const QJsonValue &event : events) {
+        const QJsonObject object = event.toObject();
+        if (object.value(QLatin1StringView("ph")).toString() != QLatin1StringView("X") || object.value(QLatin1StringView("dur")).toDouble(-1) < 0) {
+            return {};
+        }
+        names << object.value(QLatin1StringView("name")).toString();
+    }
+    return names;
+}
+
+static QString readInvitation()
+{
+    QFile file(QStringLiteral(TEST_DATA_DIR "/itip-event-request.ical"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+void TracingTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void TracingTest::cleanup()
+{
+    Tracing::setEnabled(false);
+    Tracing::clear();
+}
+
+void TracingTest::testDisabled()
+{
+    QVERIFY(!Tracing::isEnabled());
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+    const QString invitation = readInvitation();
+    QVERIFY(!invitation.isEmpty());
+    QVERIFY(!IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper).isEmpty());
+
+    const QJsonDocument document = QJsonDocument::fromJson(Tracing::toChromeTrace());
+    QVERIFY(document.isObject());
+    QVERIFY(document.object().value(QLatin1StringView("traceEvents")).toArray().isEmpty());
+}
+
+void TracingTest::testInvitationSpans()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+    const QString invitation = readInvitation();
+    QVERIFY(!invitation.isEmpty());
+
+    Tracing::setEnabled(true);
+    QVERIFY(!IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper).isEmpty());
+
+    const QStringList names = spanNames();
+    for (const char *name : {"formatICalInvitation",
+                             "parseScheduleMessage",
+                             "shiftTimes",
+                             "findExistingIncidence",
+                             "invitationHeader",
+                             "invitationBody",
+                             "buildContext",
+                             "render",
+                             "loadTemplate",
+                             "renderTemplate"}) {
+        QVERIFY2(names.contains(QLatin1StringView(name)), name);
+    }
+}
+
+void TracingTest::testDisplaySpans()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    Event::Ptr event(new Event);
+    event->setSummary(QStringLiteral("Traced"));
+    event->setDtStart(QDateTime(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc()));
+
+    Tracing::setEnabled(true);
+    QVERIFY(!IncidenceFormatter::extensiveDisplayStr(calendar, event).isEmpty());
+
+    const QStringList names = spanNames();
+    QVERIFY(names.contains(QLatin1StringView("displayViewFormatEvent")));
+    QVERIFY(names.contains(QLatin1StringView("render")));
+
+    const QString fileName = QDir::temp().filePath(QStringLiteral("kcalutils-testtracing.json"));
+    QVERIFY(Tracing::writeChromeTrace(fileName));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), Tracing::toChromeTrace());
+    file.remove();
+}
+
+#include "moc_testtracing.cpp"
@@ -0,0 +1,93 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "testwarmup.h"
+#include "test_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QThread>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(WarmUpTest)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+void WarmUpTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+
+    // Configure the paths from another thread, so that the main thread has no
+    // template manager yet and takes over the one prepared by warmUp()
+    QThread *thread = QThread::create([]() {
+        GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(TEST_TEMPLATE_PATH));
+        GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(TEST_PLUGIN_PATH));
+    });
+    thread->start();
+    QVERIFY(thread->wait());
+    delete thread;
+}
+
+void WarmUpTest::testWarmUp()
+{
+    QFuture<void> future = IncidenceFormatter::warmUp();
+    QVERIFY(future.isValid());
+    // The icons are looked up from the event loop of this thread, which
+    // must not block in waitForFinished()
+    QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 30000);
+    QCOMPARE(future.progressMinimum(), 0);
+    QCOMPARE(future.progressValue(), future.progressMaximum());
+
+    // Later calls do not warm up again
+    const QFuture<void> again = IncidenceFormatter::warmUp();
+    QVERIFY(again.isFinished());
+    QCOMPARE(again.progressValue(), future.progressValue());
+}
+
+void WarmUpTest::testFirstRenderAfterWarmUp()
+{
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    QVERIFY(format.load(calendar, QStringLiteral(TEST_DATA_DIR "/event-2.ical")));
+    const Incidence::Ptr incidence = calendar->incidences().first();
+
+    const QFuture<void> future = IncidenceFormatter::warmUp();
+    QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 30000);
+
+    // The prepared templates are kept for the application thread, another
+    // thread formatting first sets up its own
+    QString otherThread;
+    QThread *thread = QThread::create([&]() {
+        otherThread = IncidenceFormatter::extensiveDisplayStr(calendar, incidence);
+    });
+    thread->start();
+    QVERIFY(thread->wait());
+    delete thread;
+    QVERIFY(!otherThread.isEmpty());
+
+    IncidenceFormatter::resetStatistics();
+
+    // The templates were parsed in the background
+    const QString first = IncidenceFormatter::extensiveDisplayStr(calendar, incidence);
+    QVERIFY(!first.isEmpty());
+    const IncidenceFormatter::Statistics statistics = IncidenceFormatter::statistics();
+    QCOMPARE(statistics.templateCacheMisses(), quint64(0));
+    QVERIFY(statistics.templateCacheHits() > 0);
+
+    QCOMPARE(IncidenceFormatter::extensiveDisplayStr(calendar, incidence), first);
+    QCOMPARE(first, otherThread);
+}
+
+#include "moc_testwarmup.cpp"
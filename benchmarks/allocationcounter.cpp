@@ -0,0 +1,232 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "allocationcounter.h"
+
+#include "incidenceformatter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define KCALUTILS_NO_ALLOCATION_COUNTER
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define KCALUTILS_NO_ALLOCATION_COUNTER
+#endif
+
+static std::atomic<quint64> sAllocations{0};
+static std::atomic<quint64> sAllocatedBytes{0};
+
+// The same, for the calling thread only, and the heap it holds
+static thread_local quint64 tAllocations = 0;
+static thread_local quint64 tAllocatedBytes = 0;
+static thread_local qint64 tLiveBytes = 0;
+static thread_local qint64 tPeakLiveBytes = 0;
+
+static inline void countAllocation(std::size_t size)
+{
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+    sAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    ++tAllocations;
+    tAllocatedBytes += size;
+}
+
+#if !defined(KCALUTILS_NO_ALLOCATION_COUNTER) && defined(__GLIBC__)
+
+#include <cerrno>
+#include <malloc.h>
+
+// The live heap is measured in usable sizes, which are known again when
+// the block is freed
+static inline void *trackBlock(void *ptr)
+{
+    if (ptr) {
+        tLiveBytes += qint64(malloc_usable_size(ptr));
+        tPeakLiveBytes = qMax(tPeakLiveBytes, tLiveBytes);
+    }
+    return ptr;
+}
+
+static inline void untrackBlock(void *ptr)
+{
+    if (ptr) {
+        tLiveBytes -= qint64(malloc_usable_size(ptr));
+    }
+}
+
+// Qt containers allocate with malloc() rather than operator new, so on glibc
+// the C allocation functions are interposed. operator new ends up here too.
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(std::size_t size)
+{
+    countAllocation(size);
+    return trackBlock(__libc_malloc(size));
+}
+
+void *calloc(std::size_t count, std::size_t size)
+{
+    countAllocation(count * size);
+    return trackBlock(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, std::size_t size)
+{
+    countAllocation(size);
+    untrackBlock(ptr);
+    return trackBlock(__libc_realloc(ptr, size));
+}
+
+void *memalign(std::size_t alignment, std::size_t size)
+{
+    countAllocation(size);
+    return trackBlock(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(std::size_t alignment, std::size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, std::size_t alignment, std::size_t size)
+{
+    void *block = memalign(alignment, size);
+    if (!block) {
+        return ENOMEM;
+    }
+    *ptr = block;
+    return 0;
+}
+
+void free(void *ptr)
+{
+    untrackBlock(ptr);
+    __libc_free(ptr);
+}
+}
+
+bool AllocationCounter::isActive()
+{
+    return true;
+}
+
+#elif !defined(KCALUTILS_NO_ALLOCATION_COUNTER)
+
+// Elsewhere only allocations through operator new are counted. The array
+// and nothrow versions of the standard library forward to these.
+void *operator new(std::size_t size)
+{
+    countAllocation(size);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    // Exceptions are disabled in this project
+    std::abort();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+bool AllocationCounter::isActive()
+{
+    return true;
+}
+
+#else
+
+bool AllocationCounter::isActive()
+{
+    return false;
+}
+
+#endif
+
+quint64 AllocationCounter::allocations()
+{
+    return sAllocations.load(std::memory_order_relaxed);
+}
+
+quint64 AllocationCounter::allocatedBytes()
+{
+    return sAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+namespace
+{
+class Probe : public KCalUtils::IncidenceFormatter::AllocationProbe
+{
+public:
+    quint64 allocations() const override
+    {
+        return tAllocations;
+    }
+
+    quint64 allocatedBytes() const override
+    {
+        return tAllocatedBytes;
+    }
+
+    qint64 liveBytes() const override
+    {
+        return tLiveBytes;
+    }
+
+    qint64 peakLiveBytes() const override
+    {
+        return tPeakLiveBytes;
+    }
+
+    void resetPeak() override
+    {
+        tPeakLiveBytes = tLiveBytes;
+    }
+};
+}
+
+void AllocationCounter::installProbe()
+{
+    static Probe probe;
+    if (isActive()) {
+        KCalUtils::IncidenceFormatter::setAllocationProbe(&probe);
+    }
+}
+
+void AllocationCounter::reportStatistics()
+{
+    using Statistics = KCalUtils::IncidenceFormatter::Statistics;
+    static const char *const names[Statistics::EntryPointCount] = {"extensiveDisplayStr", "toolTipStr", "mailBodyStr", "formatICalInvitation", "formatICalInvitationNoHtml"};
+
+    const Statistics statistics = KCalUtils::IncidenceFormatter::statistics();
+    for (int i = 0; i < Statistics::EntryPointCount; ++i) {
+        const auto entryPoint = static_cast<Statistics::EntryPoint>(i);
+        const quint64 calls = statistics.calls(entryPoint);
+        if (calls == 0) {
+            continue;
+        }
+        qInfo("STATISTICS: %s: %llu calls, %llu allocations/call, %llu bytes/call, %llu peak bytes",
+              names[i],
+              calls,
+              statistics.allocations(entryPoint) / calls,
+              statistics.allocatedBytes(entryPoint) / calls,
+              statistics.peakBytes(entryPoint));
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+
+/**
+  Counts the heap allocations made by the process.
+
+  Linking against this library replaces the allocation functions of the
+  program, see allocationcounter.cpp. It is only meant for benchmarks.
+*/
+namespace AllocationCounter
+{
+/**
+  Returns true if allocations are counted in this build. Counting is not
+  available in sanitizer builds, which install their own allocator.
+*/
+[[nodiscard]] bool isActive();
+
+/**
+  Returns the number of allocations made since the program started.
+*/
+[[nodiscard]] quint64 allocations();
+
+/**
+  Returns the number of bytes requested since the program started.
+*/
+[[nodiscard]] quint64 allocatedBytes();
+
+/**
+  Installs an allocation probe so that IncidenceFormatter::statistics()
+  reports the allocations and the peak heap growth of each formatter call.
+  The heap growth is only tracked with glibc.
+*/
+void installProbe();
+
+/**
+  Prints the calls and allocations of each formatter entry point recorded
+  in IncidenceFormatter::statistics().
+*/
+void reportStatistics();
+
+/**
+  Runs @p func once and prints the allocations it made, in the format
+  "ALLOCATIONS: <count> allocations/op, <bytes> bytes/op".
+  Call @p func once before, so that one-time setup is not counted.
+*/
+template<typename Func>
+void report(Func &&func)
+{
+    const quint64 allocationsBefore = allocations();
+    const quint64 bytesBefore = allocatedBytes();
+    func();
+    if (isActive()) {
+        qInfo("ALLOCATIONS: %llu allocations/op, %llu bytes/op", allocations() - allocationsBefore, allocatedBytes() - bytesBefore);
+    }
+}
+}
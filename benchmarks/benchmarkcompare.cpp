@@ -0,0 +1,295 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+// Runs the benchmark executables several times, records median and 95th
+// percentile of every benchmark plus its allocations per operation as JSON,
+// and compares the result with a baseline recorded earlier.
+// The 95th percentile is interpolated linearly at rank 0.95 * (runs - 1);
+// with the default of 5 runs it lies 80% of the way from the second slowest
+// to the slowest run, and up to 21 runs it only depends on those two runs.
+// Only the median is compared with the baseline.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+struct Samples {
+    QString metric;
+    QList<double> values;
+    QList<double> allocations;
+};
+
+struct Result {
+    QString metric;
+    double median = 0;
+    double p95 = 0;
+    double allocations = -1; // -1 if not counted
+};
+}
+
+static double percentile(QList<double> values, double p)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    const double rank = p * (values.count() - 1);
+    const int lower = int(std::floor(rank));
+    const int upper = int(std::ceil(rank));
+    return values.at(lower) + (values.at(upper) - values.at(lower)) * (rank - lower);
+}
+
+// Parses the QTest XML output of one run and adds its results to @p samples
+static bool parseRun(const QString &executable, const QByteArray &xml, QMap<QString, Samples> &samples)
+{
+    static const QRegularExpression allocationsRx(QStringLiteral("^ALLOCATIONS: (\\d+) allocations/op"));
+
+    QXmlStreamReader reader(xml);
+    QString function;
+    QString messageTag;
+    bool inMessage = false;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            const auto name = reader.name();
+            if (name == QLatin1StringView("TestFunction")) {
+                function = reader.attributes().value(QLatin1StringView("name")).toString();
+            } else if (name == QLatin1StringView("BenchmarkResult")) {
+                const QXmlStreamAttributes attributes = reader.attributes();
+                const QString key = QStringLiteral("%1::%2(%3)").arg(executable, function, attributes.value(QLatin1StringView("tag")).toString());
+                Samples &s = samples[key];
+                s.metric = attributes.value(QLatin1StringView("metric")).toString();
+                s.values.append(attributes.value(QLatin1StringView("value")).toDouble());
+            } else if (name == QLatin1StringView("Message")) {
+                inMessage = true;
+                messageTag.clear();
+            } else if (inMessage && name == QLatin1StringView("DataTag")) {
+                messageTag = reader.readElementText();
+            } else if (inMessage && name == QLatin1StringView("Description")) {
+                const QRegularExpressionMatch match = allocationsRx.match(reader.readElementText());
+                if (match.hasMatch()) {
+                    const QString key = QStringLiteral("%1::%2(%3)").arg(executable, function, messageTag);
+                    samples[key].allocations.append(match.captured(1).toDouble());
+                }
+            }
+        } else if (reader.isEndElement() && reader.name() == QLatin1StringView("Message")) {
+            inMessage = false;
+        }
+    }
+    if (reader.hasError()) {
+        qWarning("%s: cannot parse the benchmark output: %s", qPrintable(executable), qPrintable(reader.errorString()));
+        return false;
+    }
+    return true;
+}
+
+static bool runBenchmarks(const QStringList &executables, int runs, QMap<QString, Samples> &samples)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    if (!environment.contains(QStringLiteral("QT_QPA_PLATFORM"))) {
+        environment.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("offscreen"));
+    }
+
+    for (const QString &executable : executables) {
+        const QString name = QFileInfo(executable).fileName();
+        for (int run = 0; run < runs; ++run) {
+            qInfo("Running %s (%d/%d)", qPrintable(name), run + 1, runs);
+            QProcess process;
+            process.setProcessEnvironment(environment);
+            process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            process.start(executable, {QStringLiteral("-o"), QStringLiteral("-,xml")});
+            if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+                qWarning("%s failed: %s", qPrintable(name), qPrintable(process.errorString()));
+                return false;
+            }
+            if (!parseRun(name, process.readAllStandardOutput(), samples)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static QJsonObject toJson(const QMap<QString, Result> &results, int runs)
+{
+    QJsonObject benchmarks;
+    for (auto it = results.cbegin(), end = results.cend(); it != end; ++it) {
+        QJsonObject result;
+        result[QStringLiteral("metric")] = it->metric;
+        result[QStringLiteral("median")] = it->median;
+        result[QStringLiteral("p95")] = it->p95;
+        if (it->allocations >= 0) {
+            result[QStringLiteral("allocations")] = it->allocations;
+        }
+        benchmarks[it.key()] = result;
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("runs")] = runs;
+    root[QStringLiteral("benchmarks")] = benchmarks;
+    return root;
+}
+
+static QMap<QString, Result> fromJson(const QJsonObject &root)
+{
+    QMap<QString, Result> results;
+    const QJsonObject benchmarks = root.value(QStringLiteral("benchmarks")).toObject();
+    for (auto it = benchmarks.constBegin(), end = benchmarks.constEnd(); it != end; ++it) {
+        const QJsonObject object = it.value().toObject();
+        Result result;
+        result.metric = object.value(QStringLiteral("metric")).toString();
+        result.median = object.value(QStringLiteral("median")).toDouble();
+        result.p95 = object.value(QStringLiteral("p95")).toDouble();
+        result.allocations = object.value(QStringLiteral("allocations")).toDouble(-1);
+        results.insert(it.key(), result);
+    }
+    return results;
+}
+
+// Returns the number of regressions; a benchmark of the baseline that did
+// not run counts as one, e.g. when it was renamed or it crashed
+static int compare(const QMap<QString, Result> &results, const QMap<QString, Result> &baseline, double timeThreshold, double allocationThreshold)
+{
+    int regressions = 0;
+    for (auto it = baseline.cbegin(), end = baseline.cend(); it != end; ++it) {
+        const auto current = results.constFind(it.key());
+        if (current == results.cend()) {
+            qWarning("MISSING    %s", qPrintable(it.key()));
+            ++regressions;
+            continue;
+        }
+
+        QStringList problems;
+        if (current->metric == it->metric && it->median > 0) {
+            const double change = (current->median - it->median) / it->median * 100.0;
+            if (change > timeThreshold) {
+                problems << QStringLiteral("median %1 -> %2 %3 (+%4%)").arg(it->median).arg(current->median).arg(current->metric).arg(change, 0, 'f', 1);
+            }
+        }
+        if (it->allocations >= 0 && current->allocations >= 0) {
+            const double limit = it->allocations * (1.0 + allocationThreshold / 100.0);
+            if (current->allocations > limit) {
+                problems << QStringLiteral("allocations %1 -> %2").arg(it->allocations).arg(current->allocations);
+            }
+        }
+
+        if (problems.isEmpty()) {
+            qInfo("OK         %s", qPrintable(it.key()));
+        } else {
+            qWarning("REGRESSION %s: %s", qPrintable(it.key()), qPrintable(problems.join(QLatin1StringView(", "))));
+            ++regressions;
+        }
+    }
+    for (auto it = results.cbegin(), end = results.cend(); it != end; ++it) {
+        if (!baseline.contains(it.key())) {
+            qInfo("NEW        %s", qPrintable(it.key()));
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kcalutils-benchmark-compare"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Runs the benchmarks and compares them with a baseline"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("executables"), QStringLiteral("The benchmark executables to run."), QStringLiteral("executable..."));
+
+    const QCommandLineOption runsOption(QStringLiteral("runs"),
+                                        QStringLiteral("Run each benchmark <n> times. Up to 21 runs, the 95th percentile is interpolated between the two slowest runs."),
+                                        QStringLiteral("n"),
+                                        QStringLiteral("5"));
+    const QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("Write the results to <file>."), QStringLiteral("file"));
+    const QCommandLineOption baselineOption(QStringLiteral("baseline"),
+                                            QStringLiteral("Compare the results with <file>, which must exist."),
+                                            QStringLiteral("file"));
+    const QCommandLineOption timeOption(QStringLiteral("time-threshold"),
+                                        QStringLiteral("Allowed increase of the median time, in percent."),
+                                        QStringLiteral("percent"),
+                                        QStringLiteral("10"));
+    const QCommandLineOption allocationOption(QStringLiteral("allocation-threshold"),
+                                              QStringLiteral("Allowed increase of the allocations per operation, in percent."),
+                                              QStringLiteral("percent"),
+                                              QStringLiteral("0"));
+    parser.addOptions({runsOption, outputOption, baselineOption, timeOption, allocationOption});
+    parser.process(app);
+
+    const QStringList executables = parser.positionalArguments();
+    if (executables.isEmpty()) {
+        parser.showHelp(1);
+    }
+    const int runs = qMax(1, parser.value(runsOption).toInt());
+
+    QMap<QString, Samples> samples;
+    if (!runBenchmarks(executables, runs, samples)) {
+        return 2;
+    }
+
+    QMap<QString, Result> results;
+    for (auto it = samples.cbegin(), end = samples.cend(); it != end; ++it) {
+        if (it->values.isEmpty()) {
+            continue;
+        }
+        Result result;
+        result.metric = it->metric;
+        result.median = percentile(it->values, 0.5);
+        result.p95 = percentile(it->values, 0.95);
+        if (!it->allocations.isEmpty()) {
+            result.allocations = percentile(it->allocations, 0.5);
+        }
+        results.insert(it.key(), result);
+    }
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning("Unable to write %s: %s", qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return 2;
+        }
+        file.write(QJsonDocument(toJson(results, runs)).toJson());
+    }
+
+    if (!parser.isSet(baselineOption)) {
+        return 0;
+    }
+    QFile baselineFile(parser.value(baselineOption));
+    if (!baselineFile.exists()) {
+        qWarning("No baseline at %s, record one first", qPrintable(baselineFile.fileName()));
+        return 2;
+    }
+    if (!baselineFile.open(QIODevice::ReadOnly)) {
+        qWarning("Unable to read %s: %s", qPrintable(baselineFile.fileName()), qPrintable(baselineFile.errorString()));
+        return 2;
+    }
+    QJsonParseError error;
+    const QJsonDocument baseline = QJsonDocument::fromJson(baselineFile.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qWarning("Unable to parse %s: %s", qPrintable(baselineFile.fileName()), qPrintable(error.errorString()));
+        return 2;
+    }
+
+    const int regressions = compare(results, fromJson(baseline.object()), parser.value(timeOption).toDouble(), parser.value(allocationOption).toDouble());
+    if (regressions > 0) {
+        qWarning("%d benchmark(s) regressed or did not run", regressions);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "benchmarkdatetimefilters.h"
+#include "allocationcounter.h"
+#include "benchmark_config.h"
+
+#include "grantleetemplatemanager_p.h"
+
+#include <QFile>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(DateTimeFiltersBenchmark)
+
+using namespace KCalUtils;
+
+namespace
+{
+// Number of filters in the benchmarked template
+constexpr int filterCount = 1000;
+}
+
+void DateTimeFiltersBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+
+    // A template made of the kdate, ktime and kdatetime filters only, with
+    // the arguments used by the calendar templates
+    static const char *const filters[] = {
+        "kdate",
+        "kdate:\"short\"",
+        "ktime",
+        "ktime:\"short\"",
+        "kdatetime",
+        "kdatetime:\"short\"",
+        "kdatetime:\"short,dateonly\"",
+    };
+    constexpr int filterVariants = sizeof(filters) / sizeof(filters[0]);
+
+    QByteArray content;
+    for (int i = 0; i < filterCount; ++i) {
+        content += "{{ incidence.dateTime|" + QByteArray(filters[i % filterVariants]) + " }}\n";
+    }
+    QVERIFY(mTemplateDir.isValid());
+    QFile file(mTemplateDir.filePath(QStringLiteral("datetimefilters.html")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+    file.close();
+
+    GrantleeTemplateManager::instance()->setTemplatePath(mTemplateDir.path());
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(BENCHMARK_PLUGIN_PATH));
+}
+
+void DateTimeFiltersBenchmark::benchmarkDateFilters()
+{
+    QVariantHash data;
+    data[QStringLiteral("dateTime")] = QDateTime(QDate(2023, 5, 2), QTime(10, 30), QTimeZone::utc());
+
+    const auto op = [&]() {
+        return GrantleeTemplateManager::instance()->render(QStringLiteral("datetimefilters.html"), data);
+    };
+    QVERIFY(op().count(QLatin1Char('\n')) >= filterCount - 1);
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+#include "moc_benchmarkdatetimefilters.cpp"
@@ -0,0 +1,64 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "benchmarkdndfactory.h"
+#include "allocationcounter.h"
+#include "benchmark_config.h"
+
+#include "dndfactory.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QDir>
+#include <QMimeData>
+#include <QTest>
+#include <QTimeZone>
+
+#include <memory>
+
+QTEST_MAIN(DndFactoryBenchmark)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+void DndFactoryBenchmark::benchmarkRoundTrip_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    const QStringList files = QDir(QStringLiteral(BENCHMARK_DATA_DIR)).entryList({QStringLiteral("*.ical")}, QDir::Files, QDir::Name);
+    for (const QString &file : files) {
+        QTest::newRow(qPrintable(file.chopped(5))) << QStringLiteral(BENCHMARK_DATA_DIR "/%1").arg(file);
+    }
+}
+
+void DndFactoryBenchmark::benchmarkRoundTrip()
+{
+    QFETCH(QString, fileName);
+
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    QVERIFY(format.load(calendar, fileName));
+    const Incidence::List incidences = calendar->incidences();
+    if (incidences.isEmpty()) {
+        QSKIP("No incidence in this file");
+    }
+    const Incidence::Ptr incidence = incidences.first();
+
+    DndFactory factory(calendar);
+    // Encode the incidence as drag data and decode it again
+    const auto op = [&]() {
+        const std::unique_ptr<QMimeData> mimeData(factory.createMimeData(incidence));
+        return DndFactory::createDropCalendar(mimeData.get());
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+#include "moc_benchmarkdndfactory.cpp"
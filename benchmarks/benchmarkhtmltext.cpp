@@ -0,0 +1,110 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "benchmarkhtmltext.h"
+#include "allocationcounter.h"
+#include "benchmark_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "htmltext_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_MAIN(HtmlTextBenchmark)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+static QString multiLineText(int lines)
+{
+    QString text;
+    for (int i = 0; i < lines; ++i) {
+        text += QStringLiteral("Agenda item %1: <b>review</b> & discuss\n").arg(i);
+    }
+    text.chop(1);
+    return text;
+}
+
+static void addLineCounts()
+{
+    QTest::addColumn<int>("lines");
+
+    for (int lines : {1000, 10000, 50000}) {
+        QTest::addRow("%d-lines", lines) << lines;
+    }
+}
+
+void HtmlTextBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(BENCHMARK_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(BENCHMARK_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void HtmlTextBenchmark::benchmarkLinesToHtml_data()
+{
+    addLineCounts();
+}
+
+void HtmlTextBenchmark::benchmarkLinesToHtml()
+{
+    QFETCH(int, lines);
+    const QString text = multiLineText(lines);
+
+    const auto op = [&]() {
+        return HtmlText::linesToHtml(text, QLatin1StringView("p"), HtmlText::Escape | HtmlText::TrailingBreak);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void HtmlTextBenchmark::benchmarkRichDescriptionInvitation_data()
+{
+    addLineCounts();
+}
+
+void HtmlTextBenchmark::benchmarkRichDescriptionInvitation()
+{
+    QFETCH(int, lines);
+
+    // Rich descriptions of invitations go through htmlAddTag()
+    Event::Ptr event(new Event);
+    event->setUid(QStringLiteral("rich-description-benchmark"));
+    event->setSummary(QStringLiteral("Long agenda"));
+    event->setDescription(multiLineText(lines), true);
+    event->setOrganizer(Person(QStringLiteral("Organizer"), QStringLiteral("organizer@example.com")));
+    const QDateTime start(QDate(2023, 5, 2), QTime(10, 0), QTimeZone::utc());
+    event->setDtStart(start);
+    event->setDtEnd(start.addSecs(3600));
+
+    ICalFormat format;
+    const QString invitation = format.createScheduleMessage(event, iTIPRequest);
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+
+    const auto op = [&]() {
+        return IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+#include "moc_benchmarkhtmltext.cpp"
@@ -0,0 +1,23 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class HtmlTextBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkLinesToHtml_data();
+    void benchmarkLinesToHtml();
+
+    void benchmarkRichDescriptionInvitation_data();
+    void benchmarkRichDescriptionInvitation();
+};
@@ -0,0 +1,216 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "benchmarkincidenceformatter.h"
+#include "allocationcounter.h"
+#include "benchmark_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QDir>
+#include <QFile>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_MAIN(IncidenceFormatterBenchmark)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+// The fixtures of the autotests, @p invitations selects the iTIP messages
+static void addDataFiles(bool invitations)
+{
+    QTest::addColumn<QString>("fileName");
+
+    const QStringList files = QDir(QStringLiteral(BENCHMARK_DATA_DIR)).entryList({QStringLiteral("*.ical")}, QDir::Files, QDir::Name);
+    for (const QString &file : files) {
+        if (file.startsWith(QLatin1StringView("itip-")) == invitations) {
+            QTest::newRow(qPrintable(file.chopped(5))) << QStringLiteral(BENCHMARK_DATA_DIR "/%1").arg(file);
+        }
+    }
+}
+
+static Calendar::Ptr loadCalendar(const QString &fileName)
+{
+    auto calendar = MemoryCalendar::Ptr::create(QTimeZone::utc());
+    ICalFormat format;
+    if (!format.load(calendar, fileName)) {
+        return {};
+    }
+    return calendar;
+}
+
+static Incidence::Ptr firstIncidence(const Calendar::Ptr &calendar)
+{
+    if (!calendar) {
+        return {};
+    }
+    const Incidence::List incidences = calendar->incidences();
+    return incidences.isEmpty() ? Incidence::Ptr() : incidences.first();
+}
+
+void IncidenceFormatterBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(BENCHMARK_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(BENCHMARK_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+    AllocationCounter::installProbe();
+}
+
+void IncidenceFormatterBenchmark::cleanupTestCase()
+{
+    AllocationCounter::reportStatistics();
+}
+
+void IncidenceFormatterBenchmark::benchmarkExtensiveDisplayStr_data()
+{
+    addDataFiles(false);
+}
+
+void IncidenceFormatterBenchmark::benchmarkExtensiveDisplayStr()
+{
+    QFETCH(QString, fileName);
+    const Calendar::Ptr calendar = loadCalendar(fileName);
+    const Incidence::Ptr incidence = firstIncidence(calendar);
+    if (!incidence) {
+        QSKIP("No incidence in this file");
+    }
+
+    const auto op = [&]() {
+        return IncidenceFormatter::extensiveDisplayStr(calendar, incidence);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void IncidenceFormatterBenchmark::benchmarkToolTipStr_data()
+{
+    addDataFiles(false);
+}
+
+void IncidenceFormatterBenchmark::benchmarkToolTipStr()
+{
+    QFETCH(QString, fileName);
+    const Incidence::Ptr incidence = firstIncidence(loadCalendar(fileName));
+    if (!incidence) {
+        QSKIP("No incidence in this file");
+    }
+
+    const auto op = [&]() {
+        return IncidenceFormatter::toolTipStr(QStringLiteral("Calendar"), incidence);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void IncidenceFormatterBenchmark::benchmarkMailBodyStr_data()
+{
+    addDataFiles(false);
+}
+
+void IncidenceFormatterBenchmark::benchmarkMailBodyStr()
+{
+    QFETCH(QString, fileName);
+    const Incidence::Ptr incidence = firstIncidence(loadCalendar(fileName));
+    if (!incidence) {
+        QSKIP("No incidence in this file");
+    }
+
+    const auto op = [&]() {
+        return IncidenceFormatter::mailBodyStr(incidence);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void IncidenceFormatterBenchmark::benchmarkRecurrenceString_data()
+{
+    addDataFiles(false);
+}
+
+void IncidenceFormatterBenchmark::benchmarkRecurrenceString()
+{
+    QFETCH(QString, fileName);
+    const Incidence::Ptr incidence = firstIncidence(loadCalendar(fileName));
+    if (!incidence) {
+        QSKIP("No incidence in this file");
+    }
+
+    const auto op = [&]() {
+        return IncidenceFormatter::recurrenceString(incidence);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void IncidenceFormatterBenchmark::benchmarkReminderStringList_data()
+{
+    addDataFiles(false);
+}
+
+void IncidenceFormatterBenchmark::benchmarkReminderStringList()
+{
+    QFETCH(QString, fileName);
+    const Incidence::Ptr incidence = firstIncidence(loadCalendar(fileName));
+    if (!incidence) {
+        QSKIP("No incidence in this file");
+    }
+
+    const auto op = [&]() {
+        return IncidenceFormatter::reminderStringList(incidence);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void IncidenceFormatterBenchmark::benchmarkFormatICalInvitation_data()
+{
+    addDataFiles(true);
+}
+
+void IncidenceFormatterBenchmark::benchmarkFormatICalInvitation()
+{
+    QFETCH(QString, fileName);
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QString invitation = QString::fromUtf8(file.readAll());
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+
+    const auto op = [&]() {
+        return IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+#include "moc_benchmarkincidenceformatter.cpp"
@@ -0,0 +1,36 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class IncidenceFormatterBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkExtensiveDisplayStr_data();
+    void benchmarkExtensiveDisplayStr();
+
+    void benchmarkToolTipStr_data();
+    void benchmarkToolTipStr();
+
+    void benchmarkMailBodyStr_data();
+    void benchmarkMailBodyStr();
+
+    void benchmarkRecurrenceString_data();
+    void benchmarkRecurrenceString();
+
+    void benchmarkReminderStringList_data();
+    void benchmarkReminderStringList();
+
+    void benchmarkFormatICalInvitation_data();
+    void benchmarkFormatICalInvitation();
+};
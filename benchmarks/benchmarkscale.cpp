@@ -0,0 +1,203 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "benchmarkscale.h"
+#include "allocationcounter.h"
+#include "benchmark_config.h"
+#include "calendargenerator.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTest>
+
+QTEST_MAIN(ScaleBenchmark)
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+namespace
+{
+// Gives the formatter access to the generated calendar, so that the
+// existing-incidence lookup and eventsOnSameDays() have work to do.
+class CalendarHelper : public InvitationFormatterHelper
+{
+public:
+    explicit CalendarHelper(const Calendar::Ptr &calendar)
+        : mCalendar(calendar)
+    {
+    }
+
+    Calendar::Ptr calendar() const override
+    {
+        return mCalendar;
+    }
+
+private:
+    Calendar::Ptr mCalendar;
+};
+}
+
+void ScaleBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setTemplatePath(QStringLiteral(BENCHMARK_TEMPLATE_PATH));
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(BENCHMARK_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+}
+
+void ScaleBenchmark::benchmarkInvitationLargeCalendar_data()
+{
+    QTest::addColumn<int>("events");
+    QTest::addColumn<bool>("inCalendar");
+
+    for (int events : {1000, 10000, 100000}) {
+        QTest::addRow("%d-events", events) << events << false;
+        QTest::addRow("%d-events-existing", events) << events << true;
+    }
+}
+
+void ScaleBenchmark::benchmarkInvitationLargeCalendar()
+{
+    QFETCH(int, events);
+    QFETCH(bool, inCalendar);
+
+    CalendarGenerator::Options options;
+    options.events = events;
+    options.recurringSeries = events / 100;
+    options.exdates = 10;
+    options.invitationInCalendar = inCalendar;
+    CalendarGenerator generator(options);
+
+    const Calendar::Ptr calendar = generator.calendar();
+    const QString invitation = generator.invitation();
+    CalendarHelper helper(calendar);
+
+    const auto op = [&]() {
+        return IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void ScaleBenchmark::benchmarkInvitationManyAttendees_data()
+{
+    QTest::addColumn<int>("attendees");
+
+    for (int attendees : {10, 100, 1000}) {
+        QTest::addRow("%d-attendees", attendees) << attendees;
+    }
+}
+
+void ScaleBenchmark::benchmarkInvitationManyAttendees()
+{
+    QFETCH(int, attendees);
+
+    CalendarGenerator::Options options;
+    options.events = 0;
+    options.attendees = attendees;
+    options.descriptionLength = 10000;
+    options.alarms = 5;
+    options.attachments = 20;
+    CalendarGenerator generator(options);
+
+    const Calendar::Ptr calendar = generator.calendar();
+    const QString invitation = generator.invitation();
+    InvitationFormatterHelper helper;
+
+    const auto op = [&]() {
+        return IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void ScaleBenchmark::benchmarkAttendeeFragments_data()
+{
+    QTest::addColumn<int>("variants");
+
+    // The same attendees on every call take the attendee rows from the
+    // fragment cache; 8 variants of 500 attendees exceed the 1000 entries
+    // kept per block, so every row is rendered again
+    QTest::addRow("500-attendees-repeated") << 1;
+    QTest::addRow("500-attendees-distinct") << 8;
+}
+
+void ScaleBenchmark::benchmarkAttendeeFragments()
+{
+    QFETCH(int, variants);
+
+    CalendarGenerator::Options options;
+    options.events = 0;
+    options.attendees = 500;
+    CalendarGenerator generator(options);
+
+    const Calendar::Ptr calendar = generator.calendar();
+    const Event::Ptr event = generator.invitationEvent();
+    QList<Event::Ptr> events;
+    for (int i = 0; i < variants; ++i) {
+        Event::Ptr variant(event->clone());
+        Attendee::List attendees = variant->attendees();
+        for (Attendee &attendee : attendees) {
+            attendee.setName(attendee.name() + QStringLiteral(" (%1)").arg(i));
+        }
+        variant->setAttendees(attendees);
+        events.append(variant);
+    }
+
+    int next = 0;
+    const auto op = [&]() {
+        const Event::Ptr &incidence = events.at(next);
+        next = (next + 1) % events.size();
+        return IncidenceFormatter::extensiveDisplayStr(calendar, incidence);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+void ScaleBenchmark::benchmarkDenseFreeBusy_data()
+{
+    QTest::addColumn<int>("periods");
+
+    for (int periods : {100, 1000, 10000}) {
+        QTest::addRow("%d-periods", periods) << periods;
+    }
+}
+
+void ScaleBenchmark::benchmarkDenseFreeBusy()
+{
+    QFETCH(int, periods);
+
+    CalendarGenerator::Options options;
+    options.events = 0;
+    options.busyPeriods = periods;
+    CalendarGenerator generator(options);
+
+    const Calendar::Ptr calendar = generator.calendar();
+    const FreeBusy::Ptr freeBusy = generator.freeBusy();
+
+    const auto op = [&]() {
+        return IncidenceFormatter::extensiveDisplayStr(calendar, freeBusy);
+    };
+    op();
+    AllocationCounter::report(op);
+    QBENCHMARK {
+        op();
+    }
+}
+
+#include "moc_benchmarkscale.cpp"
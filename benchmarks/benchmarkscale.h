@@ -0,0 +1,29 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class ScaleBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkInvitationLargeCalendar_data();
+    void benchmarkInvitationLargeCalendar();
+
+    void benchmarkInvitationManyAttendees_data();
+    void benchmarkInvitationManyAttendees();
+
+    void benchmarkAttendeeFragments_data();
+    void benchmarkAttendeeFragments();
+
+    void benchmarkDenseFreeBusy_data();
+    void benchmarkDenseFreeBusy();
+};
@@ -0,0 +1,181 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "calendargenerator.h"
+
+#include <KCalendarCore/ICalFormat>
+
+#include <QTimeZone>
+
+using namespace KCalendarCore;
+
+static const QString invitationUid = QStringLiteral("generated-invitation");
+
+// All generated incidences use this as creation and modification time,
+// so that the output does not depend on when it was generated.
+static QDateTime fixedTimestamp()
+{
+    return QDateTime(QDate(2024, 1, 1), QTime(0, 0), QTimeZone::utc());
+}
+
+CalendarGenerator::CalendarGenerator(const Options &options)
+    : mOptions(options)
+    , mRandom(options.seed)
+{
+}
+
+QDateTime CalendarGenerator::randomStart()
+{
+    const QDate date = mOptions.startDate.addDays(mRandom.bounded(qMax(1, mOptions.days)));
+    // Start on a quarter hour between 07:00 and 19:00
+    return QDateTime(date, QTime(7, 0).addSecs(mRandom.bounded(48) * 15 * 60), QTimeZone::utc());
+}
+
+QString CalendarGenerator::description(int index)
+{
+    if (mOptions.descriptionLength <= 0) {
+        return QStringLiteral("Description of incidence %1").arg(index);
+    }
+
+    static const QString paragraph = QStringLiteral(
+        "<p>Please review the <b>attached documents</b> before the meeting. "
+        "The agenda is available at <a href=\"https://example.com/agenda\">https://example.com/agenda</a>.</p>\n");
+    QString html;
+    html.reserve(mOptions.descriptionLength + paragraph.size());
+    html += QStringLiteral("<html><body>");
+    while (html.size() < mOptions.descriptionLength) {
+        html += paragraph;
+    }
+    html += QStringLiteral("</body></html>");
+    return html;
+}
+
+void CalendarGenerator::fillIncidence(const Incidence::Ptr &incidence, int index)
+{
+    incidence->setCreated(fixedTimestamp());
+    incidence->setSummary(QStringLiteral("Generated incidence %1").arg(index));
+    incidence->setLocation(QStringLiteral("Room %1").arg(mRandom.bounded(100)));
+    incidence->setDescription(description(index), mOptions.descriptionLength > 0);
+    incidence->setOrganizer(Person(QStringLiteral("Organizer %1").arg(index % 10), QStringLiteral("organizer%1@example.com").arg(index % 10)));
+
+    static const Attendee::PartStat statuses[] = {Attendee::NeedsAction, Attendee::Accepted, Attendee::Declined, Attendee::Tentative};
+    static const Attendee::Role roles[] = {Attendee::ReqParticipant, Attendee::OptParticipant, Attendee::NonParticipant, Attendee::Chair};
+    for (int i = 0; i < mOptions.attendees; ++i) {
+        Attendee attendee(QStringLiteral("Attendee %1").arg(i), QStringLiteral("attendee%1@example.com").arg(i), true);
+        attendee.setStatus(statuses[mRandom.bounded(4)]);
+        attendee.setRole(roles[mRandom.bounded(4)]);
+        incidence->addAttendee(attendee, false);
+    }
+
+    for (int i = 0; i < mOptions.alarms; ++i) {
+        Alarm::Ptr alarm = incidence->newAlarm();
+        alarm->setDisplayAlarm(QStringLiteral("Reminder %1").arg(i));
+        alarm->setStartOffset(Duration(-(i + 1) * 5 * 60));
+        alarm->setEnabled(true);
+    }
+
+    static const QString mimeTypes[] = {QStringLiteral("application/pdf"),
+                                        QStringLiteral("application/vnd.oasis.opendocument.text"),
+                                        QStringLiteral("image/png"),
+                                        QStringLiteral("text/plain")};
+    for (int i = 0; i < mOptions.attachments; ++i) {
+        Attachment attachment(QStringLiteral("https://example.com/documents/%1/%2").arg(index).arg(i), mimeTypes[i % 4]);
+        attachment.setLabel(QStringLiteral("document-%1").arg(i));
+        incidence->addAttachment(attachment);
+    }
+
+    incidence->setLastModified(fixedTimestamp());
+}
+
+MemoryCalendar::Ptr CalendarGenerator::calendar()
+{
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+
+    for (int i = 0; i < mOptions.events; ++i) {
+        Event::Ptr event(new Event);
+        event->setUid(QStringLiteral("generated-event-%1").arg(i));
+        const QDateTime start = randomStart();
+        event->setDtStart(start);
+        event->setDtEnd(start.addSecs((1 + mRandom.bounded(8)) * 15 * 60));
+        fillIncidence(event, i);
+        calendar->addEvent(event);
+    }
+
+    for (int i = 0; i < mOptions.recurringSeries; ++i) {
+        Event::Ptr event(new Event);
+        event->setUid(QStringLiteral("generated-series-%1").arg(i));
+        const QDateTime start = randomStart();
+        event->setDtStart(start);
+        event->setDtEnd(start.addSecs(3600));
+        fillIncidence(event, mOptions.events + i);
+
+        Recurrence *recurrence = event->recurrence();
+        recurrence->setWeekly(1);
+        recurrence->setDuration(mOptions.exdates + 52);
+        for (int j = 0; j < mOptions.exdates; ++j) {
+            recurrence->addExDate(start.date().addDays(7 * (j + 1)));
+        }
+        calendar->addEvent(event);
+    }
+
+    if (mOptions.invitationInCalendar) {
+        Event::Ptr event = invitationEvent();
+        event->setSchedulingID(invitationUid, QStringLiteral("generated-invitation-copy"));
+        calendar->addEvent(event);
+    }
+
+    return calendar;
+}
+
+Event::Ptr CalendarGenerator::invitationEvent()
+{
+    // Use a separate generator, so the invitation does not depend on
+    // whether calendar() was called before
+    CalendarGenerator generator(mOptions);
+
+    Event::Ptr event(new Event);
+    event->setUid(invitationUid);
+    const QDateTime start(mOptions.startDate, QTime(10, 0), QTimeZone::utc());
+    event->setDtStart(start);
+    event->setDtEnd(start.addSecs(3600));
+    generator.fillIncidence(event, -1);
+    return event;
+}
+
+QString CalendarGenerator::invitation()
+{
+    ICalFormat format;
+    return format.createScheduleMessage(invitationEvent(), iTIPRequest);
+}
+
+FreeBusy::Ptr CalendarGenerator::freeBusy()
+{
+    const QDateTime start(mOptions.startDate, QTime(0, 0), QTimeZone::utc());
+    const QDateTime end = start.addDays(qMax(1, mOptions.days));
+
+    // Dense, partly overlapping periods in chronological order
+    Period::List periods;
+    periods.reserve(mOptions.busyPeriods);
+    const qint64 step = mOptions.busyPeriods > 0 ? start.secsTo(end) / mOptions.busyPeriods : 0;
+    for (int i = 0; i < mOptions.busyPeriods; ++i) {
+        const QDateTime periodStart = start.addSecs(i * step);
+        periods.append(Period(periodStart, periodStart.addSecs(qMax<qint64>(60, step / 2 + mRandom.bounded(int(qMax<qint64>(1, step)))))));
+    }
+
+    FreeBusy::Ptr freeBusy(new FreeBusy(periods));
+    freeBusy->setUid(QStringLiteral("generated-freebusy"));
+    freeBusy->setDtStart(start);
+    freeBusy->setDtEnd(end);
+    freeBusy->setOrganizer(Person(QStringLiteral("Resource"), QStringLiteral("resource@example.com")));
+    freeBusy->setLastModified(fixedTimestamp());
+    return freeBusy;
+}
+
+QString CalendarGenerator::freeBusyReply()
+{
+    ICalFormat format;
+    return format.createScheduleMessage(freeBusy(), iTIPReply);
+}
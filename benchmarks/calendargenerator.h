@@ -0,0 +1,88 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/FreeBusy>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QDate>
+#include <QRandomGenerator>
+
+/**
+  Builds calendars and iTIP messages of configurable size for benchmarks
+  and stress tests.
+
+  The output only depends on the options: the same options, including the
+  seed, always produce the same calendar.
+*/
+class CalendarGenerator
+{
+public:
+    struct Options {
+        quint32 seed = 1;
+        /// First day of the generated time range
+        QDate startDate = QDate(2024, 1, 1);
+        /// Number of days the generated incidences are spread over
+        int days = 30;
+        /// Number of single events in the calendar
+        int events = 100;
+        /// Number of weekly recurring series in the calendar
+        int recurringSeries = 0;
+        /// Number of exception dates per recurring series
+        int exdates = 0;
+        /// Number of attendees per incidence
+        int attendees = 3;
+        /// Length of the HTML descriptions, in characters; 0 for plain text ones
+        int descriptionLength = 0;
+        /// Number of alarms per incidence
+        int alarms = 0;
+        /// Number of attachments per incidence
+        int attachments = 0;
+        /// Number of busy periods in free/busy objects
+        int busyPeriods = 0;
+        /// Add the event of the invitation to the calendar, with a different uid
+        /// but a matching scheduling id, at the end of the calendar
+        bool invitationInCalendar = false;
+    };
+
+    explicit CalendarGenerator(const Options &options);
+
+    /**
+      Returns a calendar with the configured number of events and series.
+    */
+    [[nodiscard]] KCalendarCore::MemoryCalendar::Ptr calendar();
+
+    /**
+      Returns the event the invitations are about. It takes place on the
+      first generated day, so it overlaps with the calendar.
+    */
+    [[nodiscard]] KCalendarCore::Event::Ptr invitationEvent();
+
+    /**
+      Returns an iTIP request for invitationEvent().
+    */
+    [[nodiscard]] QString invitation();
+
+    /**
+      Returns a free/busy object with the configured number of busy periods.
+    */
+    [[nodiscard]] KCalendarCore::FreeBusy::Ptr freeBusy();
+
+    /**
+      Returns an iTIP reply carrying freeBusy().
+    */
+    [[nodiscard]] QString freeBusyReply();
+
+private:
+    void fillIncidence(const KCalendarCore::Incidence::Ptr &incidence, int index);
+    [[nodiscard]] QString description(int index);
+    [[nodiscard]] QDateTime randomStart();
+
+    const Options mOptions;
+    QRandomGenerator mRandom;
+};
@@ -0,0 +1,102 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "calendargenerator.h"
+
+#include <KCalendarCore/ICalFormat>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+
+using namespace KCalendarCore;
+
+static bool writeFile(const QString &fileName, const QString &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Unable to write %s: %s", qPrintable(fileName), qPrintable(file.errorString()));
+        return false;
+    }
+    file.write(data.toUtf8());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kcalutils-generate-calendar"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Generates calendars and invitations of configurable size for benchmarks"));
+    parser.addHelpOption();
+
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the random generator."), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption daysOption(QStringLiteral("days"), QStringLiteral("Number of days to spread incidences over."), QStringLiteral("n"), QStringLiteral("30"));
+    const QCommandLineOption eventsOption(QStringLiteral("events"), QStringLiteral("Number of single events."), QStringLiteral("n"), QStringLiteral("100"));
+    const QCommandLineOption seriesOption(QStringLiteral("recurring"), QStringLiteral("Number of recurring series."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption exdatesOption(QStringLiteral("exdates"), QStringLiteral("Exception dates per series."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption attendeesOption(QStringLiteral("attendees"), QStringLiteral("Attendees per incidence."), QStringLiteral("n"), QStringLiteral("3"));
+    const QCommandLineOption descriptionOption(QStringLiteral("description-length"),
+                                               QStringLiteral("Length of HTML descriptions, 0 for plain text."),
+                                               QStringLiteral("n"),
+                                               QStringLiteral("0"));
+    const QCommandLineOption alarmsOption(QStringLiteral("alarms"), QStringLiteral("Alarms per incidence."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption attachmentsOption(QStringLiteral("attachments"), QStringLiteral("Attachments per incidence."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption busyOption(QStringLiteral("busy-periods"), QStringLiteral("Busy periods in the free/busy reply."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption inCalendarOption(QStringLiteral("invitation-in-calendar"),
+                                              QStringLiteral("Add the invited event to the calendar, found through its scheduling id."));
+    const QCommandLineOption calendarOption(QStringLiteral("calendar"), QStringLiteral("Write the calendar to <file>."), QStringLiteral("file"));
+    const QCommandLineOption invitationOption(QStringLiteral("invitation"), QStringLiteral("Write an iTIP request to <file>."), QStringLiteral("file"));
+    const QCommandLineOption freeBusyOption(QStringLiteral("freebusy"), QStringLiteral("Write an iTIP free/busy reply to <file>."), QStringLiteral("file"));
+    parser.addOptions({seedOption,
+                       daysOption,
+                       eventsOption,
+                       seriesOption,
+                       exdatesOption,
+                       attendeesOption,
+                       descriptionOption,
+                       alarmsOption,
+                       attachmentsOption,
+                       busyOption,
+                       inCalendarOption,
+                       calendarOption,
+                       invitationOption,
+                       freeBusyOption});
+    parser.process(app);
+
+    if (!parser.isSet(calendarOption) && !parser.isSet(invitationOption) && !parser.isSet(freeBusyOption)) {
+        qWarning("Nothing to do, use --calendar, --invitation or --freebusy");
+        parser.showHelp(1);
+    }
+
+    CalendarGenerator::Options options;
+    options.seed = parser.value(seedOption).toUInt();
+    options.days = parser.value(daysOption).toInt();
+    options.events = parser.value(eventsOption).toInt();
+    options.recurringSeries = parser.value(seriesOption).toInt();
+    options.exdates = parser.value(exdatesOption).toInt();
+    options.attendees = parser.value(attendeesOption).toInt();
+    options.descriptionLength = parser.value(descriptionOption).toInt();
+    options.alarms = parser.value(alarmsOption).toInt();
+    options.attachments = parser.value(attachmentsOption).toInt();
+    options.busyPeriods = parser.value(busyOption).toInt();
+    options.invitationInCalendar = parser.isSet(inCalendarOption);
+
+    CalendarGenerator generator(options);
+    bool ok = true;
+    if (parser.isSet(calendarOption)) {
+        ICalFormat format;
+        ok = format.save(generator.calendar(), parser.value(calendarOption)) && ok;
+    }
+    if (parser.isSet(invitationOption)) {
+        ok = writeFile(parser.value(invitationOption), generator.invitation()) && ok;
+    }
+    if (parser.isSet(freeBusyOption)) {
+        ok = writeFile(parser.value(freeBusyOption), generator.freeBusyReply()) && ok;
+    }
+    return ok ? 0 : 1;
+}
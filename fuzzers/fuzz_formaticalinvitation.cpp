@@ -0,0 +1,66 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fuzzhelper.h"
+
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QTimeZone>
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+namespace
+{
+// Makes the formatter compare the invitation with what is in the calendar
+class CalendarHelper : public InvitationFormatterHelper
+{
+public:
+    explicit CalendarHelper(const Calendar::Ptr &calendar)
+        : mCalendar(calendar)
+    {
+    }
+
+    Calendar::Ptr calendar() const override
+    {
+        return mCalendar;
+    }
+
+private:
+    const Calendar::Ptr mCalendar;
+};
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+    FuzzHelper::initialize();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char *>(data), qsizetype(size));
+    const QString invitation = QString::fromUtf8(raw);
+
+    FuzzHelper::InputBudget budget;
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    InvitationFormatterHelper helper;
+    (void)IncidenceFormatter::formatICalInvitation(invitation, calendar, &helper);
+    (void)IncidenceFormatter::formatICalInvitationNoHtml(invitation, calendar, &helper, QStringLiteral("organizer@example.com"));
+
+    // The same message again, this time as an update of what the calendar holds
+    MemoryCalendar::Ptr existing(new MemoryCalendar(QTimeZone::utc()));
+    ICalFormat format;
+    if (format.fromRawString(existing, raw)) {
+        CalendarHelper calendarHelper(existing);
+        (void)IncidenceFormatter::formatICalInvitation(invitation, calendar, &calendarHelper);
+    }
+    return 0;
+}
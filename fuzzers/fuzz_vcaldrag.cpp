@@ -0,0 +1,35 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fuzzhelper.h"
+
+#include "vcaldrag.h"
+
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QMimeData>
+#include <QTimeZone>
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+    FuzzHelper::initialize();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    QMimeData mimeData;
+    mimeData.setData(VCalDrag::mimeType(), QByteArray(reinterpret_cast<const char *>(data), qsizetype(size)));
+
+    FuzzHelper::InputBudget budget;
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    (void)VCalDrag::fromMimeData(&mimeData, calendar);
+    return 0;
+}
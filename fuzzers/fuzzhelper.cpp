@@ -0,0 +1,141 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fuzzhelper.h"
+#include "fuzzer_config.h"
+
+#include "grantleetemplatemanager_p.h"
+#include "incidenceformatter.h"
+
+#include <QApplication>
+#include <QLocale>
+#include <QStandardPaths>
+
+#include <sanitizer/allocator_interface.h>
+
+static qint64 timeBudget()
+{
+    static const qint64 budget = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("KCALUTILS_FUZZ_TIME_BUDGET_MS", &ok);
+        return ok && value > 0 ? qint64(value) : qint64(2000);
+    }();
+    return budget;
+}
+
+static qint64 heapBudget()
+{
+    static const qint64 budget = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("KCALUTILS_FUZZ_HEAP_BUDGET_MB", &ok);
+        return (ok && value > 0 ? qint64(value) : qint64(256)) * 1024 * 1024;
+    }();
+    return budget;
+}
+
+namespace
+{
+// Counters of the calling thread, updated by the allocator hooks of the
+// sanitizer. They must not allocate, so they are plain thread_local values.
+thread_local quint64 tAllocations = 0;
+thread_local quint64 tAllocatedBytes = 0;
+thread_local qint64 tLiveBytes = 0;
+thread_local qint64 tPeakLiveBytes = 0;
+
+void mallocHook(const volatile void *ptr, size_t size)
+{
+    Q_UNUSED(ptr)
+    ++tAllocations;
+    tAllocatedBytes += size;
+    tLiveBytes += qint64(size);
+    if (tLiveBytes > tPeakLiveBytes) {
+        tPeakLiveBytes = tLiveBytes;
+    }
+}
+
+void freeHook(const volatile void *ptr)
+{
+    // The hook runs before the block is released, so its size is known
+    const void *block = const_cast<const void *>(ptr);
+    if (block && __sanitizer_get_ownership(block)) {
+        tLiveBytes -= qint64(__sanitizer_get_allocated_size(block));
+    }
+}
+
+// The fuzzers run with AddressSanitizer, which owns malloc() and free(), so
+// the allocations are counted through its hooks instead of by replacing the
+// allocation functions like the benchmarks do
+class SanitizerProbe : public KCalUtils::IncidenceFormatter::AllocationProbe
+{
+public:
+    quint64 allocations() const override
+    {
+        return tAllocations;
+    }
+
+    quint64 allocatedBytes() const override
+    {
+        return tAllocatedBytes;
+    }
+
+    qint64 liveBytes() const override
+    {
+        return tLiveBytes;
+    }
+
+    qint64 peakLiveBytes() const override
+    {
+        return tPeakLiveBytes;
+    }
+
+    void resetPeak() override
+    {
+        tPeakLiveBytes = tLiveBytes;
+    }
+};
+
+SanitizerProbe sProbe;
+}
+
+void FuzzHelper::initialize()
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    // The invitation formatter reads colors from the application palette
+    static int argc = 1;
+    static char name[] = "kcalutils-fuzzer";
+    static char *argv[] = {name, nullptr};
+    static QApplication app(argc, argv);
+
+    QStandardPaths::setTestModeEnabled(true);
+    GrantleeTemplateManager::instance()->setPluginPath(QStringLiteral(FUZZER_PLUGIN_PATH));
+    QLocale::setDefault(QLocale(QStringLiteral("C")));
+
+    if (__sanitizer_install_malloc_and_free_hooks(mallocHook, freeHook)) {
+        KCalUtils::IncidenceFormatter::setAllocationProbe(&sProbe);
+    }
+}
+
+FuzzHelper::InputBudget::InputBudget()
+{
+    sProbe.resetPeak();
+    mLiveBytes = sProbe.liveBytes();
+    mTimer.start();
+}
+
+FuzzHelper::InputBudget::~InputBudget()
+{
+    const qint64 elapsed = mTimer.elapsed();
+    if (elapsed > timeBudget()) {
+        qFatal("Input took %lld ms, the budget is %lld ms", elapsed, timeBudget());
+    }
+    const qint64 heapGrowth = sProbe.peakLiveBytes() - mLiveBytes;
+    if (heapGrowth > heapBudget()) {
+        qFatal("Input grew the heap by %lld bytes, the budget is %lld bytes", heapGrowth, heapBudget());
+    }
+}
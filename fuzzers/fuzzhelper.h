@@ -0,0 +1,52 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+
+/**
+  Shared setup of the libFuzzer targets.
+*/
+namespace FuzzHelper
+{
+/**
+  Creates the application object, points the template engine to the
+  plugins of the build tree and installs an allocation probe based on the
+  AddressSanitizer allocator hooks, so that
+  KCalUtils::IncidenceFormatter::statistics() reports the allocations of
+  the formatter calls. Call from LLVMFuzzerInitialize().
+*/
+void initialize();
+
+/**
+  Aborts, and so makes libFuzzer save the input, if processing one input
+  takes longer than the time budget or grows the heap of the calling thread
+  by more than the heap budget.
+
+  The time budget is 2000 ms unless set in milliseconds with the
+  KCALUTILS_FUZZ_TIME_BUDGET_MS environment variable. It is far below the
+  libFuzzer -timeout so that inputs triggering super-linear behavior are
+  reported even when they finish eventually.
+
+  The heap budget is 256 MB unless set in megabytes with the
+  KCALUTILS_FUZZ_HEAP_BUDGET_MB environment variable. Unlike the
+  -rss_limit_mb option of libFuzzer, it catches an input that allocates
+  much more than the previous ones while the process is still below the
+  limit; -malloc_limit_mb bounds single allocations.
+*/
+class InputBudget
+{
+public:
+    InputBudget();
+    ~InputBudget();
+
+private:
+    Q_DISABLE_COPY(InputBudget)
+    QElapsedTimer mTimer;
+    qint64 mLiveBytes = 0;
+};
+}
@@ -0,0 +1,104 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "busyperiods_p.h"
+
+#include <QBitArray>
+#include <QMap>
+
+#include <algorithm>
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+Period::List BusyPeriods::coalesce(Period::List periods)
+{
+    std::stable_sort(periods.begin(), periods.end(), [](const Period &a, const Period &b) {
+        return a.start() < b.start();
+    });
+
+    Period::List result;
+    result.reserve(periods.count());
+    for (const Period &period : std::as_const(periods)) {
+        if (!result.isEmpty() && period.start() <= result.constLast().end()) {
+            if (period.end() > result.constLast().end()) {
+                result.last() = Period(result.constLast().start(), period.end());
+            }
+            continue;
+        }
+        result.append(period);
+    }
+    return result;
+}
+
+static int slotForTime(QTime time, bool roundUp)
+{
+    const int minutes = time.msecsSinceStartOfDay() / 60000;
+    return roundUp ? (minutes + BusyPeriods::slotMinutes - 1) / BusyPeriods::slotMinutes : minutes / BusyPeriods::slotMinutes;
+}
+
+QList<BusyPeriods::DayTimeline> BusyPeriods::timeline(const Period::List &periods, const QDateTime &rangeStart, const QDateTime &rangeEnd)
+{
+    QDateTime firstStart;
+    QDateTime lastEnd;
+    for (const Period &period : periods) {
+        if (period.start().isValid() && (!firstStart.isValid() || period.start() < firstStart)) {
+            firstStart = period.start();
+        }
+        if (period.end().isValid() && (!lastEnd.isValid() || period.end() > lastEnd)) {
+            lastEnd = period.end();
+        }
+    }
+    QDateTime windowStart = rangeStart.isValid() ? std::max(rangeStart, firstStart) : firstStart;
+    QDateTime windowEnd = rangeEnd.isValid() ? std::min(rangeEnd, lastEnd) : lastEnd;
+    if (!windowStart.isValid() || !windowEnd.isValid()) {
+        return {};
+    }
+    // A FREEBUSY line from 1900 to 9999 must not allocate millions of days
+    windowEnd = std::min(windowEnd, windowStart.toLocalTime().date().addDays(maxTimelineDays).startOfDay());
+
+    QMap<QDate, QBitArray> days;
+    for (const Period &period : periods) {
+        const QDateTime start = std::max(period.start(), windowStart).toLocalTime();
+        const QDateTime end = std::min(period.end(), windowEnd).toLocalTime();
+        if (!period.start().isValid() || !start.isValid() || end <= start) {
+            continue;
+        }
+        for (QDate date = start.date(); date <= end.date(); date = date.addDays(1)) {
+            const int first = date == start.date() ? slotForTime(start.time(), false) : 0;
+            const int last = date == end.date() ? slotForTime(end.time(), true) : slotsPerDay;
+            if (last <= first) {
+                // Ends at midnight
+                continue;
+            }
+            QBitArray &slots = days[date];
+            if (slots.isEmpty()) {
+                slots.resize(slotsPerDay);
+            }
+            slots.fill(true, first, last);
+        }
+    }
+
+    QList<DayTimeline> result;
+    result.reserve(days.count());
+    for (auto it = days.cbegin(), end = days.cend(); it != end; ++it) {
+        DayTimeline day;
+        day.date = it.key();
+        const QBitArray &slots = it.value();
+        for (int i = 0; i < slotsPerDay; ++i) {
+            if (!slots.testBit(i)) {
+                continue;
+            }
+            const int first = i;
+            while (i < slotsPerDay && slots.testBit(i)) {
+                ++i;
+            }
+            day.ranges.append(qMakePair(first, i));
+        }
+        result.append(day);
+    }
+    return result;
+}
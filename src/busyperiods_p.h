@@ -0,0 +1,59 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kcalutils_private_export.h"
+
+#include <KCalendarCore/Period>
+
+#include <QDate>
+#include <QDateTime>
+#include <QList>
+#include <QPair>
+
+namespace KCalUtils
+{
+/**
+  Helpers to condense long lists of free/busy periods before they are
+  formatted.
+*/
+namespace BusyPeriods
+{
+/// The granularity of the per-day timeline, in minutes
+constexpr int slotMinutes = 15;
+constexpr int slotsPerDay = 24 * 60 / slotMinutes;
+/// The most days a timeline covers, however long the free/busy range is
+constexpr int maxTimelineDays = 366;
+
+/**
+  The busy time of one day, as ranges [first, last) of timeline slots.
+*/
+struct DayTimeline {
+    QDate date;
+    QList<QPair<int, int>> ranges;
+};
+
+/**
+  Sorts @p periods by start time and merges overlapping and adjacent ones.
+  Periods that do not touch any other period are returned unchanged.
+*/
+[[nodiscard]] KCALUTILS_TESTS_EXPORT KCalendarCore::Period::List coalesce(KCalendarCore::Period::List periods);
+
+/**
+  Projects @p periods onto a per-day timeline in local time. Only days
+  with busy time are returned, in chronological order.
+
+  Periods are clamped to [@p rangeStart, @p rangeEnd], the range of the
+  free/busy object; an invalid bound is ignored. The timeline then covers
+  at most maxTimelineDays days from the first busy time, so the size of
+  the result is bounded by maxTimelineDays, not by the number of periods
+  or their length.
+*/
+[[nodiscard]] KCALUTILS_TESTS_EXPORT QList<DayTimeline>
+timeline(const KCalendarCore::Period::List &periods, const QDateTime &rangeStart, const QDateTime &rangeEnd);
+}
+}
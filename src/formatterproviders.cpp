@@ -0,0 +1,244 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "formatterproviders_p.h"
+#include "formatterstatistics_p.h"
+#include "guiprovidersinterface_p.h"
+#include "kcalutils_debug.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPluginLoader>
+#include <QThread>
+
+#include <atomic>
+
+using namespace KCalUtils;
+using namespace KCalUtils::IncidenceFormatter;
+
+namespace
+{
+// Colors of the Breeze light color scheme
+constexpr QLatin1StringView noteColorName("#3daee9");
+constexpr QLatin1StringView buttonBackgroundColorName("#fcfcfc");
+constexpr QLatin1StringView buttonBorderColorName("#474747");
+constexpr QLatin1StringView buttonTextColorName("#232629");
+
+// Default sizes of the KIconLoader groups, from Desktop to Dialog
+constexpr int groupSizes[] = {32, 22, 22, 16, 48, 32};
+constexpr int groupCount = sizeof(groupSizes) / sizeof(groupSizes[0]);
+
+// Source of the revisions of all icon providers
+std::atomic<quint64> sIconRevisions;
+
+const ColorProvider sBuiltinColorProvider;
+const IconProvider sBuiltinIconProvider;
+
+std::atomic<ColorProvider *> sColorProvider;
+std::atomic<ColorProvider *> sDefaultColorProvider;
+std::atomic<IconProvider *> sIconProvider;
+std::atomic<IconProvider *> sDefaultIconProvider;
+std::atomic<bool> sGuiProvidersLoaded;
+std::atomic<bool> sGuiProvidersRequested;
+std::atomic<IconMode> sIconMode{IconFilePaths};
+
+// Applications with a QGuiApplication get the colors of their palette and the
+// icons of their icon theme, from a plugin so that this library does not
+// depend on the GUI modules. The palette and the icon loader belong to the
+// application thread, so the plugin is only loaded there.
+void loadGuiProviders()
+{
+    if (sGuiProvidersLoaded.load(std::memory_order_acquire)) {
+        return;
+    }
+    // Try again once the application object exists
+    QCoreApplication *app = QCoreApplication::instance();
+    if (!app) {
+        return;
+    }
+    if (app->inherits("QGuiApplication") && QThread::currentThread() != app->thread()) {
+        // Other threads use the built-in providers until the application
+        // thread has loaded the plugin
+        if (!sGuiProvidersRequested.exchange(true, std::memory_order_relaxed)) {
+            QMetaObject::invokeMethod(
+                app,
+                []() {
+                    loadGuiProviders();
+                },
+                Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (sGuiProvidersLoaded.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (app->inherits("QGuiApplication")) {
+        QPluginLoader loader(QStringLiteral("pim6/kcalutils/kcalutils_guiproviders"));
+        if (auto *plugin = qobject_cast<KCalUtils::GuiProvidersInterface *>(loader.instance())) {
+            sDefaultColorProvider.store(plugin->colorProvider(), std::memory_order_release);
+            sDefaultIconProvider.store(plugin->iconProvider(), std::memory_order_release);
+        } else {
+            // The formatted HTML loses its icons and palette colors, which
+            // points at a broken installation rather than a headless process
+            qCCritical(KCALUTILS_LOG) << "Unable to load the GUI providers, using built-in colors and no icons:" << loader.errorString();
+        }
+    }
+    sGuiProvidersLoaded.store(true, std::memory_order_release);
+}
+}
+
+ColorProvider::~ColorProvider() = default;
+
+QString ColorProvider::color(ColorRole role) const
+{
+    switch (role) {
+    case DiffColor:
+        break;
+    case NoteColor:
+        return noteColorName;
+    case ButtonBackgroundColor:
+        return buttonBackgroundColorName;
+    case ButtonBorderColor:
+        return buttonBorderColorName;
+    case ButtonTextColor:
+        return buttonTextColorName;
+    }
+    return QStringLiteral("#ff0000");
+}
+
+IconProvider::IconProvider()
+    : mRevision(sIconRevisions.fetch_add(1, std::memory_order_relaxed) + 1)
+{
+}
+
+IconProvider::~IconProvider() = default;
+
+QString IconProvider::iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const
+{
+    Q_UNUSED(name)
+    Q_UNUSED(sizeOrGroup)
+    Q_UNUSED(canReturnNull)
+    return QString();
+}
+
+int IconProvider::iconSize(int sizeOrGroup) const
+{
+    if (sizeOrGroup >= 0 && sizeOrGroup < groupCount) {
+        return groupSizes[sizeOrGroup];
+    }
+    return sizeOrGroup;
+}
+
+quint64 IconProvider::revision() const
+{
+    return mRevision.load(std::memory_order_acquire);
+}
+
+void IconProvider::iconsChanged()
+{
+    mRevision.store(sIconRevisions.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void IncidenceFormatter::setColorProvider(ColorProvider *provider)
+{
+    sColorProvider.store(provider, std::memory_order_release);
+}
+
+const ColorProvider *IncidenceFormatter::colorProvider()
+{
+    if (const ColorProvider *provider = sColorProvider.load(std::memory_order_acquire)) {
+        return provider;
+    }
+    loadGuiProviders();
+    if (const ColorProvider *provider = sDefaultColorProvider.load(std::memory_order_acquire)) {
+        return provider;
+    }
+    return &sBuiltinColorProvider;
+}
+
+void IncidenceFormatter::setIconProvider(IconProvider *provider)
+{
+    sIconProvider.store(provider, std::memory_order_release);
+}
+
+const IconProvider *IncidenceFormatter::iconProvider()
+{
+    if (const IconProvider *provider = sIconProvider.load(std::memory_order_acquire)) {
+        return provider;
+    }
+    loadGuiProviders();
+    if (const IconProvider *provider = sDefaultIconProvider.load(std::memory_order_acquire)) {
+        return provider;
+    }
+    return &sBuiltinIconProvider;
+}
+
+void IncidenceFormatter::setIconMode(IconMode mode)
+{
+    sIconMode.store(mode, std::memory_order_relaxed);
+}
+
+IconMode IncidenceFormatter::iconMode()
+{
+    return sIconMode.load(std::memory_order_relaxed);
+}
+
+QString FormatterProviders::iconDataUri(const QString &iconPath)
+{
+    if (iconPath.isEmpty()) {
+        return QString();
+    }
+
+    // The same few icons appear in every message, read and encode each one
+    // once. A new icon theme may put other files at the same paths.
+    static QMutex mutex;
+    static QHash<QString, QString> dataUris;
+    static quint64 dataUrisRevision = 0;
+    static qint64 dataUrisMemory = 0;
+
+    const quint64 revision = IncidenceFormatter::iconProvider()->revision();
+    QMutexLocker locker(&mutex);
+    if (revision != dataUrisRevision) {
+        dataUris.clear();
+        FormatterStatistics::addCacheMemory(-dataUrisMemory);
+        dataUrisMemory = 0;
+        dataUrisRevision = revision;
+    }
+    const auto it = dataUris.constFind(iconPath);
+    if (it != dataUris.constEnd()) {
+        return *it;
+    }
+    // Other threads keep using the cache while the file is read; a second
+    // thread missing the same icon meanwhile just encodes it too
+    locker.unlock();
+
+    QFile file(iconPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Not kept, the icon may be installed later
+        qCWarning(KCALUTILS_LOG) << "Unable to read icon" << iconPath << ":" << file.errorString();
+        return QString();
+    }
+    static const QMimeDatabase mimeDb;
+    const QByteArray data = file.readAll();
+    const QMimeType mimeType = mimeDb.mimeTypeForFileNameAndData(iconPath, data);
+    const QString dataUri = QLatin1String("data:") + mimeType.name() + QLatin1String(";base64,") + QString::fromLatin1(data.toBase64());
+
+    locker.relock();
+    if (revision == dataUrisRevision && !dataUris.contains(iconPath)) {
+        dataUris.insert(iconPath, dataUri);
+        const qint64 size = (iconPath.size() + dataUri.size()) * qint64(sizeof(QChar));
+        dataUrisMemory += size;
+        FormatterStatistics::addCacheMemory(size);
+    }
+    return dataUri;
+}
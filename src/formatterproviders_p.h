@@ -0,0 +1,28 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kcalutilscore_export.h"
+
+#include <QString>
+
+namespace KCalUtils
+{
+namespace FormatterProviders
+{
+/// KIconLoader::Small, the formatter does not depend on KIconThemes itself
+constexpr int smallIconGroup = 3;
+
+/**
+  Returns the data: URI embedding the icon file at @p iconPath, or an empty
+  string if the file cannot be read. Encoded icons are kept until the
+  revision of the icon provider changes; failures are not kept.
+  Exported for the template plugin only.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT QString iconDataUri(const QString &iconPath);
+}
+}
@@ -0,0 +1,237 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "formatterstatistics_p.h"
+
+#include <atomic>
+
+using namespace KCalUtils;
+using Statistics = IncidenceFormatter::Statistics;
+
+namespace
+{
+struct Counters {
+    std::atomic<quint64> calls[Statistics::EntryPointCount];
+    std::atomic<quint64> callNanoseconds[Statistics::EntryPointCount];
+    std::atomic<quint64> bytesProduced[Statistics::EntryPointCount];
+    std::atomic<quint64> allocations[Statistics::EntryPointCount];
+    std::atomic<quint64> allocatedBytes[Statistics::EntryPointCount];
+    std::atomic<quint64> peakBytes[Statistics::EntryPointCount];
+    std::atomic<quint64> phaseNanoseconds[Statistics::PhaseCount];
+    std::atomic<quint64> invitationParses;
+    std::atomic<quint64> templateCacheHits;
+    std::atomic<quint64> templateCacheMisses;
+    std::atomic<qint64> cacheMemory;
+};
+
+// Zero-initialized, the counters are usable before any constructor ran
+Counters sCounters;
+std::atomic<IncidenceFormatter::AllocationProbe *> sProbe;
+
+inline void increase(std::atomic<quint64> &counter, quint64 value)
+{
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+}
+
+namespace KCalUtils::IncidenceFormatter
+{
+class StatisticsPrivate
+{
+public:
+    static StatisticsPrivate *get(Statistics &statistics)
+    {
+        return statistics.d.get();
+    }
+
+    quint64 calls[Statistics::EntryPointCount] = {};
+    quint64 callNanoseconds[Statistics::EntryPointCount] = {};
+    quint64 bytesProduced[Statistics::EntryPointCount] = {};
+    quint64 allocations[Statistics::EntryPointCount] = {};
+    quint64 allocatedBytes[Statistics::EntryPointCount] = {};
+    quint64 peakBytes[Statistics::EntryPointCount] = {};
+    quint64 phaseNanoseconds[Statistics::PhaseCount] = {};
+    quint64 invitationParses = 0;
+    quint64 templateCacheHits = 0;
+    quint64 templateCacheMisses = 0;
+    quint64 cacheMemory = 0;
+};
+}
+
+using IncidenceFormatter::StatisticsPrivate;
+
+static bool isValid(Statistics::EntryPoint entryPoint)
+{
+    return entryPoint >= 0 && entryPoint < Statistics::EntryPointCount;
+}
+
+Statistics::Statistics()
+    : d(new StatisticsPrivate)
+{
+}
+
+Statistics::Statistics(const Statistics &other)
+    : d(new StatisticsPrivate(*other.d))
+{
+}
+
+Statistics &Statistics::operator=(const Statistics &other)
+{
+    *d = *other.d;
+    return *this;
+}
+
+Statistics::~Statistics() = default;
+
+quint64 Statistics::calls(EntryPoint entryPoint) const
+{
+    return isValid(entryPoint) ? d->calls[entryPoint] : 0;
+}
+
+quint64 Statistics::callNanoseconds(EntryPoint entryPoint) const
+{
+    return isValid(entryPoint) ? d->callNanoseconds[entryPoint] : 0;
+}
+
+quint64 Statistics::bytesProduced(EntryPoint entryPoint) const
+{
+    return isValid(entryPoint) ? d->bytesProduced[entryPoint] : 0;
+}
+
+quint64 Statistics::allocations(EntryPoint entryPoint) const
+{
+    return isValid(entryPoint) ? d->allocations[entryPoint] : 0;
+}
+
+quint64 Statistics::allocatedBytes(EntryPoint entryPoint) const
+{
+    return isValid(entryPoint) ? d->allocatedBytes[entryPoint] : 0;
+}
+
+quint64 Statistics::peakBytes(EntryPoint entryPoint) const
+{
+    return isValid(entryPoint) ? d->peakBytes[entryPoint] : 0;
+}
+
+quint64 Statistics::phaseNanoseconds(Phase phase) const
+{
+    return phase >= 0 && phase < PhaseCount ? d->phaseNanoseconds[phase] : 0;
+}
+
+quint64 Statistics::invitationParses() const
+{
+    return d->invitationParses;
+}
+
+quint64 Statistics::templateCacheHits() const
+{
+    return d->templateCacheHits;
+}
+
+quint64 Statistics::templateCacheMisses() const
+{
+    return d->templateCacheMisses;
+}
+
+quint64 Statistics::cacheMemory() const
+{
+    return d->cacheMemory;
+}
+
+void FormatterStatistics::countCall(Statistics::EntryPoint entryPoint, qint64 nanoseconds, qint64 bytes)
+{
+    increase(sCounters.calls[entryPoint], 1);
+    increase(sCounters.callNanoseconds[entryPoint], nanoseconds);
+    increase(sCounters.bytesProduced[entryPoint], bytes);
+}
+
+void FormatterStatistics::countAllocations(Statistics::EntryPoint entryPoint, quint64 allocations, quint64 bytes, qint64 peakBytes)
+{
+    increase(sCounters.allocations[entryPoint], allocations);
+    increase(sCounters.allocatedBytes[entryPoint], bytes);
+    if (peakBytes <= 0) {
+        return;
+    }
+    std::atomic<quint64> &peak = sCounters.peakBytes[entryPoint];
+    quint64 current = peak.load(std::memory_order_relaxed);
+    while (current < quint64(peakBytes)) {
+        if (peak.compare_exchange_weak(current, quint64(peakBytes), std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+IncidenceFormatter::AllocationProbe *FormatterStatistics::allocationProbe()
+{
+    return sProbe.load(std::memory_order_acquire);
+}
+
+void FormatterStatistics::countInvitationParse()
+{
+    increase(sCounters.invitationParses, 1);
+}
+
+void FormatterStatistics::countTemplateLookup(bool cached)
+{
+    increase(cached ? sCounters.templateCacheHits : sCounters.templateCacheMisses, 1);
+}
+
+void FormatterStatistics::addPhaseTime(Statistics::Phase phase, qint64 nanoseconds)
+{
+    increase(sCounters.phaseNanoseconds[phase], nanoseconds);
+}
+
+void FormatterStatistics::addCacheMemory(qint64 bytes)
+{
+    sCounters.cacheMemory.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+Statistics IncidenceFormatter::statistics()
+{
+    Statistics statistics;
+    StatisticsPrivate *result = StatisticsPrivate::get(statistics);
+    for (int i = 0; i < Statistics::EntryPointCount; ++i) {
+        result->calls[i] = sCounters.calls[i].load(std::memory_order_relaxed);
+        result->callNanoseconds[i] = sCounters.callNanoseconds[i].load(std::memory_order_relaxed);
+        result->bytesProduced[i] = sCounters.bytesProduced[i].load(std::memory_order_relaxed);
+        result->allocations[i] = sCounters.allocations[i].load(std::memory_order_relaxed);
+        result->allocatedBytes[i] = sCounters.allocatedBytes[i].load(std::memory_order_relaxed);
+        result->peakBytes[i] = sCounters.peakBytes[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < Statistics::PhaseCount; ++i) {
+        result->phaseNanoseconds[i] = sCounters.phaseNanoseconds[i].load(std::memory_order_relaxed);
+    }
+    result->invitationParses = sCounters.invitationParses.load(std::memory_order_relaxed);
+    result->templateCacheHits = sCounters.templateCacheHits.load(std::memory_order_relaxed);
+    result->templateCacheMisses = sCounters.templateCacheMisses.load(std::memory_order_relaxed);
+    result->cacheMemory = qMax<qint64>(0, sCounters.cacheMemory.load(std::memory_order_relaxed));
+    return statistics;
+}
+
+void IncidenceFormatter::resetStatistics()
+{
+    for (int i = 0; i < Statistics::EntryPointCount; ++i) {
+        sCounters.calls[i].store(0, std::memory_order_relaxed);
+        sCounters.callNanoseconds[i].store(0, std::memory_order_relaxed);
+        sCounters.bytesProduced[i].store(0, std::memory_order_relaxed);
+        sCounters.allocations[i].store(0, std::memory_order_relaxed);
+        sCounters.allocatedBytes[i].store(0, std::memory_order_relaxed);
+        sCounters.peakBytes[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < Statistics::PhaseCount; ++i) {
+        sCounters.phaseNanoseconds[i].store(0, std::memory_order_relaxed);
+    }
+    sCounters.invitationParses.store(0, std::memory_order_relaxed);
+    sCounters.templateCacheHits.store(0, std::memory_order_relaxed);
+    sCounters.templateCacheMisses.store(0, std::memory_order_relaxed);
+}
+
+IncidenceFormatter::AllocationProbe::~AllocationProbe() = default;
+
+void IncidenceFormatter::setAllocationProbe(AllocationProbe *probe)
+{
+    sProbe.store(probe, std::memory_order_release);
+}
@@ -0,0 +1,110 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceformatter.h"
+#include "tracing_p.h"
+
+namespace KCalUtils
+{
+/**
+  Updates the counters returned by IncidenceFormatter::statistics().
+*/
+namespace FormatterStatistics
+{
+using Statistics = IncidenceFormatter::Statistics;
+
+void countCall(Statistics::EntryPoint entryPoint, qint64 nanoseconds, qint64 bytes);
+void countAllocations(Statistics::EntryPoint entryPoint, quint64 allocations, quint64 bytes, qint64 peakBytes);
+[[nodiscard]] IncidenceFormatter::AllocationProbe *allocationProbe();
+void countInvitationParse();
+void countTemplateLookup(bool cached);
+void addPhaseTime(Statistics::Phase phase, qint64 nanoseconds);
+void addCacheMemory(qint64 bytes);
+
+/**
+  Counts a call of @p entryPoint, the time until its destruction and, if a
+  probe is installed, the allocations made in between.
+  Pass the returned string through result() to count its size.
+*/
+class CallScope
+{
+public:
+    explicit CallScope(Statistics::EntryPoint entryPoint)
+        : mEntryPoint(entryPoint)
+        , mProbe(allocationProbe())
+    {
+        if (mProbe) {
+            mProbe->resetPeak();
+            mAllocations = mProbe->allocations();
+            mAllocatedBytes = mProbe->allocatedBytes();
+            mLiveBytes = mProbe->liveBytes();
+        }
+        mStart = Tracing::now();
+    }
+
+    ~CallScope()
+    {
+        countCall(mEntryPoint, Tracing::now() - mStart, mBytes);
+        if (mProbe) {
+            countAllocations(mEntryPoint,
+                             mProbe->allocations() - mAllocations,
+                             mProbe->allocatedBytes() - mAllocatedBytes,
+                             mProbe->peakLiveBytes() - mLiveBytes);
+        }
+    }
+
+    [[nodiscard]] QString result(QString str)
+    {
+        mBytes = str.size() * qint64(sizeof(QChar));
+        return str;
+    }
+
+private:
+    Q_DISABLE_COPY(CallScope)
+    const Statistics::EntryPoint mEntryPoint;
+    IncidenceFormatter::AllocationProbe *const mProbe;
+    qint64 mStart = 0;
+    qint64 mBytes = 0;
+    quint64 mAllocations = 0;
+    quint64 mAllocatedBytes = 0;
+    qint64 mLiveBytes = 0;
+};
+
+/**
+  Adds the time between its construction and its destruction (or the call
+  to end()) to @p phase.
+*/
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(Statistics::Phase phase)
+        : mPhase(phase)
+        , mStart(Tracing::now())
+    {
+    }
+
+    ~PhaseTimer()
+    {
+        end();
+    }
+
+    void end()
+    {
+        if (mStart >= 0) {
+            addPhaseTime(mPhase, Tracing::now() - mStart);
+            mStart = -1;
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(PhaseTimer)
+    const Statistics::Phase mPhase;
+    qint64 mStart;
+};
+}
+}
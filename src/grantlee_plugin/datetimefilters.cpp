@@ -9,6 +9,24 @@
 #include "../incidenceformatter.h"
 #include <KTextTemplate/SafeString>
 
+int DateTimeFilterArguments::options(const QVariant &argument) const
+{
+    const QString arguments = argument.value<KTextTemplate::SafeString>().get();
+    auto it = mOptions.constFind(arguments);
+    if (it == mOptions.constEnd()) {
+        int options = 0;
+        const QStringList list = arguments.split(QLatin1Char(','));
+        if (list.contains(QLatin1String("short"), Qt::CaseInsensitive)) {
+            options |= ShortFormat;
+        }
+        if (list.contains(QLatin1String("dateonly"), Qt::CaseInsensitive)) {
+            options |= DateOnly;
+        }
+        it = mOptions.insert(arguments, options);
+    }
+    return *it;
+}
+
 KDateFilter::KDateFilter()
     : KTextTemplate::Filter()
 {
@@ -30,7 +48,7 @@ QVariant KDateFilter::doFilter(const QVariant &input, const QVariant &argument,
     } else {
         return QString();
     }
-    const bool shortFmt = (argument.value<KTextTemplate::SafeString>().get().compare(QLatin1String("short"), Qt::CaseInsensitive) == 0);
+    const bool shortFmt = mArguments.options(argument) & DateTimeFilterArguments::ShortFormat;
     return KTextTemplate::SafeString(KCalUtils::IncidenceFormatter::dateToString(date, shortFmt));
 }
 
@@ -61,7 +79,7 @@ QVariant KTimeFilter::doFilter(const QVariant &input, const QVariant &argument,
         return QString();
     }
 
-    const bool shortFmt = (argument.value<KTextTemplate::SafeString>().get().compare(QLatin1String("short"), Qt::CaseInsensitive) == 0);
+    const bool shortFmt = mArguments.options(argument) & DateTimeFilterArguments::ShortFormat;
     return KTextTemplate::SafeString(KCalUtils::IncidenceFormatter::timeToString(time, shortFmt));
 }
 
@@ -86,9 +104,9 @@ QVariant KDateTimeFilter::doFilter(const QVariant &input, const QVariant &argume
         return QString();
     }
     const QDateTime dt = input.toDateTime();
-    const QStringList arguments = argument.value<KTextTemplate::SafeString>().get().split(QLatin1Char(','));
-    const bool shortFmt = arguments.contains(QLatin1String("short"), Qt::CaseInsensitive);
-    const bool dateOnly = arguments.contains(QLatin1String("dateonly"), Qt::CaseInsensitive);
+    const int options = mArguments.options(argument);
+    const bool shortFmt = options & DateTimeFilterArguments::ShortFormat;
+    const bool dateOnly = options & DateTimeFilterArguments::DateOnly;
     return KTextTemplate::SafeString(KCalUtils::IncidenceFormatter::dateTimeToString(dt, dateOnly, shortFmt));
 }
 
@@ -7,7 +7,29 @@
 
 #pragma once
 #include <KTextTemplate/Filter>
+#include <QHash>
 #include <QObject>
+
+/**
+ * The filters are created for each parsed template and only used by the
+ * thread rendering it. They parse each distinct argument string once and
+ * remember the resulting options, instead of comparing strings on every
+ * render.
+ */
+class DateTimeFilterArguments
+{
+public:
+    enum Option {
+        ShortFormat = 1,
+        DateOnly = 2,
+    };
+
+    [[nodiscard]] int options(const QVariant &argument) const;
+
+private:
+    mutable QHash<QString, int> mOptions;
+};
+
 class KDateFilter : public KTextTemplate::Filter
 {
 public:
@@ -19,6 +41,7 @@ public:
 
 private:
     Q_DISABLE_COPY(KDateFilter)
+    DateTimeFilterArguments mArguments;
 };
 class KTimeFilter : public KTextTemplate::Filter
 {
@@ -31,6 +54,7 @@ public:
 
 private:
     Q_DISABLE_COPY(KTimeFilter)
+    DateTimeFilterArguments mArguments;
 };
 class KDateTimeFilter : public KTextTemplate::Filter
 {
@@ -43,4 +67,5 @@ public:
 
 private:
     Q_DISABLE_COPY(KDateTimeFilter)
+    DateTimeFilterArguments mArguments;
 };
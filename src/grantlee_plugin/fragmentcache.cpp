@@ -0,0 +1,136 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fragmentcache.h"
+
+#include <KTextTemplate/Exception>
+#include <KTextTemplate/Parser>
+#include <KTextTemplate/SafeString>
+#include <KTextTemplate/Util>
+
+#include <KLocalizedString>
+
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace
+{
+// Entries kept per block before the cache is started over
+constexpr int maxFragments = 1000;
+
+void appendKey(QString &key, const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::QVariantHash: {
+        const QVariantHash hash = value.toHash();
+        QStringList names = hash.keys();
+        std::sort(names.begin(), names.end());
+        key += QLatin1Char('{');
+        for (const QString &name : std::as_const(names)) {
+            key += name + QLatin1Char(':');
+            appendKey(key, hash.value(name));
+        }
+        key += QLatin1Char('}');
+        break;
+    }
+    case QMetaType::QVariantList: {
+        key += QLatin1Char('[');
+        const QVariantList list = value.toList();
+        for (const QVariant &item : list) {
+            appendKey(key, item);
+        }
+        key += QLatin1Char(']');
+        break;
+    }
+    default:
+        key += QString::number(value.userType()) + QLatin1Char('=');
+        if (value.canConvert<KTextTemplate::SafeString>()) {
+            key += value.value<KTextTemplate::SafeString>().get();
+        } else {
+            key += value.toString();
+        }
+        break;
+    }
+    // Separates the values, which may contain any character
+    key += QChar(0x1e);
+}
+}
+
+FragmentCacheTag::FragmentCacheTag(QObject *parent)
+    : KTextTemplate::AbstractNodeFactory(parent)
+{
+}
+
+FragmentCacheTag::~FragmentCacheTag()
+{
+}
+
+KTextTemplate::Node *FragmentCacheTag::getNode(const QString &tagContent, KTextTemplate::Parser *p) const
+{
+    const QStringList parts = smartSplit(tagContent);
+    if (parts.size() < 2) {
+        throw KTextTemplate::Exception(KTextTemplate::TagSyntaxError, QStringLiteral("fragmentcache tag takes at least 1 argument"));
+    }
+
+    QList<KTextTemplate::FilterExpression> variables;
+    variables.reserve(parts.size() - 1);
+    for (int i = 1; i < parts.size(); ++i) {
+        variables.push_back(KTextTemplate::FilterExpression(parts.at(i), p));
+    }
+
+    auto node = new FragmentCacheNode(variables, p);
+    const KTextTemplate::NodeList nodeList = p->parse(node, QStringLiteral("endfragmentcache"));
+    node->setNodeList(nodeList);
+    p->removeNextToken();
+    return node;
+}
+
+FragmentCacheNode::FragmentCacheNode(const QList<KTextTemplate::FilterExpression> &variables, QObject *parent)
+    : KTextTemplate::Node(parent)
+    , mVariables(variables)
+{
+}
+
+FragmentCacheNode::~FragmentCacheNode()
+{
+}
+
+void FragmentCacheNode::setNodeList(const KTextTemplate::NodeList &nodeList)
+{
+    mNodeList = nodeList;
+}
+
+void FragmentCacheNode::render(KTextTemplate::OutputStream *stream, KTextTemplate::Context *c) const
+{
+    // Set once per render by the template manager; KLocalizedString::languages()
+    // copies the list under a global lock, too costly for every row
+    QString key = c->lookup(QStringLiteral("kcalutilsLocaleKey")).toString();
+    if (key.isEmpty()) {
+        key = c->localizer()->currentLocale() + QLatin1Char(';') + KLocalizedString::languages().join(QLatin1Char(','));
+    }
+    key += QLatin1Char(';');
+    for (const KTextTemplate::FilterExpression &variable : mVariables) {
+        appendKey(key, variable.resolve(c));
+    }
+
+    auto it = mFragments.constFind(key);
+    if (it == mFragments.constEnd()) {
+        QString content;
+        QTextStream textStream(&content);
+        auto temp = stream->clone(&textStream);
+        mNodeList.render(temp.get(), c);
+        textStream.flush();
+
+        if (mFragments.size() >= maxFragments) {
+            mFragments.clear();
+        }
+        it = mFragments.insert(key, content);
+    }
+    (*stream) << KTextTemplate::markSafe(*it);
+}
+
+#include "moc_fragmentcache.cpp"
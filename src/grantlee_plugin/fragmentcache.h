@@ -0,0 +1,59 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+#include <KTextTemplate/FilterExpression>
+#include <KTextTemplate/Node>
+
+#include <QHash>
+#include <QObject>
+
+/**
+ * @name fragmentcache tag
+ * @brief Provides {% fragmentcache %} tag for reusing rendered fragments
+ *
+ * The syntax is:
+ * @code
+ * {% fragmentcache var1 [ var2 ... ] %}
+ * ...
+ * {% endfragmentcache %}
+ * @endcode
+ *
+ * The content of the block is rendered once for each combination of the
+ * values of the variables, the locale and the translation languages, and
+ * taken from the cache afterwards. The block must only depend on these
+ * variables; icons, which depend on the icon theme, should be kept out of it.
+ * Pass the fields the block uses rather than a whole hash: every value is
+ * part of the key, and unrelated ones only make it longer and less reused.
+ *
+ * The locale and the languages are taken from the kcalutilsLocaleKey
+ * variable, which the calendar template manager sets once per render.
+ *
+ * The cache belongs to the parsed template and is dropped with it.
+ */
+class FragmentCacheTag : public KTextTemplate::AbstractNodeFactory
+{
+    Q_OBJECT
+public:
+    explicit FragmentCacheTag(QObject *parent = nullptr);
+    ~FragmentCacheTag() override;
+    KTextTemplate::Node *getNode(const QString &tagContent, KTextTemplate::Parser *p) const override;
+};
+
+class FragmentCacheNode : public KTextTemplate::Node
+{
+    Q_OBJECT
+public:
+    FragmentCacheNode(const QList<KTextTemplate::FilterExpression> &variables, QObject *parent = nullptr);
+    ~FragmentCacheNode() override;
+    void setNodeList(const KTextTemplate::NodeList &nodeList);
+    void render(KTextTemplate::OutputStream *stream, KTextTemplate::Context *c) const override;
+
+private:
+    const QList<KTextTemplate::FilterExpression> mVariables;
+    KTextTemplate::NodeList mNodeList;
+    mutable QHash<QString, QString> mFragments;
+};
@@ -6,12 +6,40 @@
  */
 
 #include "icon.h"
+#include "../formatterproviders_p.h"
+#include "../incidenceformatter.h"
 
 #include <KTextTemplate/Exception>
 #include <KTextTemplate/Parser>
-#include <KTextTemplate/Variable>
 
-#include <KIconLoader>
+namespace
+{
+// Values of KIconLoader::Group and KIconLoader::StdSizes. The icons are
+// resolved by IncidenceFormatter::iconProvider(), the plugin does not need
+// KIconThemes itself.
+enum IconSizeOrGroup {
+    Toolbar = 1,
+    MainToolbar = 2,
+    Small = 3,
+    Dialog = 5,
+    SizeSmall = 16,
+    SizeSmallMedium = 22,
+    SizeMedium = 32,
+    SizeLarge = 48,
+    SizeHuge = 64,
+    SizeEnormous = 128,
+};
+
+bool isStringLiteral(const QString &arg)
+{
+    return arg.size() >= 2 && arg.startsWith(QLatin1Char('"')) && arg.endsWith(QLatin1Char('"'));
+}
+
+QString unquote(const QString &literal)
+{
+    return literal.mid(1, literal.size() - 2);
+}
+}
 
 IconTag::IconTag(QObject *parent)
     : KTextTemplate::AbstractNodeFactory(parent)
@@ -25,16 +53,16 @@ KTextTemplate::Node *IconTag::getNode(const QString &tagContent, KTextTemplate::
 {
     Q_UNUSED(p)
 
-    static QHash<QString, int> sizeOrGroupLookup = {{QStringLiteral("toolbar"), KIconLoader::Toolbar},
-                                                    {QStringLiteral("maintoolbar"), KIconLoader::MainToolbar},
-                                                    {QStringLiteral("small"), KIconLoader::Small},
-                                                    {QStringLiteral("dialog"), KIconLoader::Dialog},
-                                                    {QStringLiteral("sizesmall"), KIconLoader::SizeSmall},
-                                                    {QStringLiteral("sizesmallmedium"), KIconLoader::SizeSmallMedium},
-                                                    {QStringLiteral("sizemedium"), KIconLoader::SizeMedium},
-                                                    {QStringLiteral("sizelarge"), KIconLoader::SizeLarge},
-                                                    {QStringLiteral("sizehuge"), KIconLoader::SizeHuge},
-                                                    {QStringLiteral("sizeenormous"), KIconLoader::SizeEnormous}};
+    static const QHash<QString, int> sizeOrGroupLookup = {{QStringLiteral("toolbar"), Toolbar},
+                                                          {QStringLiteral("maintoolbar"), MainToolbar},
+                                                          {QStringLiteral("small"), Small},
+                                                          {QStringLiteral("dialog"), Dialog},
+                                                          {QStringLiteral("sizesmall"), SizeSmall},
+                                                          {QStringLiteral("sizesmallmedium"), SizeSmallMedium},
+                                                          {QStringLiteral("sizemedium"), SizeMedium},
+                                                          {QStringLiteral("sizelarge"), SizeLarge},
+                                                          {QStringLiteral("sizehuge"), SizeHuge},
+                                                          {QStringLiteral("sizeenormous"), SizeEnormous}};
 
     const QStringList parts = smartSplit(tagContent);
     const int partsSize = parts.size();
@@ -45,7 +73,7 @@ KTextTemplate::Node *IconTag::getNode(const QString &tagContent, KTextTemplate::
         throw KTextTemplate::Exception(KTextTemplate::TagSyntaxError, QStringLiteral("icon tag takes at maximum 3 arguments, %1 given").arg(partsSize));
     }
 
-    int sizeOrGroup = KIconLoader::Small;
+    int sizeOrGroup = Small;
     QString altText;
     if (partsSize >= 3) {
         const QString sizeStr = parts.at(2);
@@ -72,53 +100,84 @@ KTextTemplate::Node *IconTag::getNode(const QString &tagContent, KTextTemplate::
 
 IconNode::IconNode(QObject *parent)
     : KTextTemplate::Node(parent)
-    , mSizeOrGroup(KIconLoader::Small)
+    , mSizeOrGroup(Small)
 {
 }
 
 IconNode::IconNode(const QString &iconName, int sizeOrGroup, const QString &altText, QObject *parent)
     : KTextTemplate::Node(parent)
-    , mIconName(iconName)
-    , mAltText(altText)
     , mSizeOrGroup(sizeOrGroup)
 {
+    if (isStringLiteral(iconName)) {
+        // Looked up on the first render, on the thread that renders
+        mIconName = unquote(iconName);
+    } else {
+        mIconNameVariable = KTextTemplate::Variable(iconName);
+    }
+
+    if (isStringLiteral(altText)) {
+        mAltText = unquote(altText);
+    } else if (!altText.isEmpty()) {
+        mAltTextVariable = KTextTemplate::Variable(altText);
+    }
 }
 
 IconNode::~IconNode()
 {
 }
-void IconNode::render(KTextTemplate::OutputStream *stream, KTextTemplate::Context *c) const
+
+QString IconNode::literalIconPath(const KCalUtils::IncidenceFormatter::IconProvider *icons) const
 {
-    Q_UNUSED(c)
+    // Read the revision before the lookup, so a theme change in between
+    // makes the next render look the icon up again
+    const quint64 revision = icons->revision();
+    if (icons != mIconProvider || revision != mIconRevision) {
+        mIconPath = icons->iconPath(mIconName, mSizeOrGroup, false);
+        mIconProvider = icons;
+        mIconRevision = revision;
+    }
+    return mIconPath;
+}
 
+void IconNode::render(KTextTemplate::OutputStream *stream, KTextTemplate::Context *c) const
+{
     QString iconName = mIconName;
-    if (iconName.startsWith(QLatin1Char('"')) && iconName.endsWith(QLatin1Char('"'))) {
-        iconName = iconName.mid(1, iconName.size() - 2);
-    } else {
-        iconName = KTextTemplate::Variable(mIconName).resolve(c).toString();
+    if (mIconNameVariable.isValid()) {
+        iconName = mIconNameVariable.resolve(c).toString();
     }
 
-    QString altText;
-    if (!mAltText.isEmpty()) {
-        if (mAltText.startsWith(QLatin1Char('"')) && mAltText.endsWith(QLatin1Char('"'))) {
-            altText = mAltText.mid(1, mAltText.size() - 2);
-        } else {
-            const QVariant v = KTextTemplate::Variable(mAltText).resolve(c);
-            if (v.isValid()) {
-                if (v.canConvert<KTextTemplate::SafeString>()) {
-                    altText = v.value<KTextTemplate::SafeString>().get();
-                } else {
-                    altText = v.toString();
-                }
+    QString altText = mAltText;
+    if (mAltTextVariable.isValid()) {
+        const QVariant v = mAltTextVariable.resolve(c);
+        if (v.isValid()) {
+            if (v.canConvert<KTextTemplate::SafeString>()) {
+                altText = v.value<KTextTemplate::SafeString>().get();
+            } else {
+                altText = v.toString();
             }
         }
     }
 
-    const QString html =
-        QStringLiteral("<img src=\"file://%1\" align=\"top\" height=\"%2\" width=\"%2\" alt=\"%3\" title=\"%4\" />")
-            .arg(KIconLoader::global()->iconPath(iconName, mSizeOrGroup))
-            .arg(mSizeOrGroup < KIconLoader::LastGroup ? KIconLoader::global()->currentSize(static_cast<KIconLoader::Group>(mSizeOrGroup)) : mSizeOrGroup)
-            .arg(altText.isEmpty() ? iconName : altText, altText); // title is intentionally blank if no alt is provided
+    const KCalUtils::IncidenceFormatter::IconProvider *icons = KCalUtils::IncidenceFormatter::iconProvider();
+    const QString iconPath = mIconNameVariable.isValid() ? icons->iconPath(iconName, mSizeOrGroup, false) : literalIconPath(icons);
+    if (iconPath.isEmpty()) {
+        // No icon, e.g. without a QGuiApplication; leave it out rather than
+        // emitting a broken image
+        return;
+    }
+    const int iconSize = icons->iconSize(mSizeOrGroup);
+
+    const QString iconUrl = KCalUtils::IncidenceFormatter::iconMode() == KCalUtils::IncidenceFormatter::IconDataUris
+        ? KCalUtils::FormatterProviders::iconDataUri(iconPath)
+        : QLatin1String("file://") + iconPath;
+    if (iconUrl.isEmpty()) {
+        return;
+    }
+
+    const QString html = QStringLiteral("<img src=\"%1\" align=\"top\" height=\"%2\" width=\"%2\" alt=\"%3\" title=\"%4\" />")
+                             .arg(iconUrl)
+                             .arg(iconSize)
+                             .arg(altText.isEmpty() ? iconName : altText, altText); // title is intentionally blank if no alt is provided
     (*stream) << KTextTemplate::SafeString(html, KTextTemplate::SafeString::IsSafe);
 }
 
@@ -7,8 +7,17 @@
 
 #pragma once
 #include <KTextTemplate/Node>
+#include <KTextTemplate/Variable>
 #include <QObject>
 
+namespace KCalUtils
+{
+namespace IncidenceFormatter
+{
+class IconProvider;
+}
+}
+
 /**
  * @name icon tag
  * @brief Provides {% icon %} tag for inserting themed icons
@@ -28,9 +37,16 @@
  * <img src="/usr/share/icons/[theme]/[type]/[size]/[icon-name].png" width="[width]" height="[height]">
  * @endcode
  *
- * The full path to the icon is resolved using KIconLoader::iconPath(). The
- * @p width and @p height attributes are calculated based on current settings
- * for icon sizes in KDE.
+ * The full path to the icon and the @p width and @p height attributes are
+ * resolved by KCalUtils::IncidenceFormatter::iconProvider(), which uses
+ * KIconLoader and the current settings for icon sizes in KDE by default.
+ * Nothing is generated if the provider resolves no path for the icon.
+ *
+ * With KCalUtils::IncidenceFormatter::IconDataUris, the icon is embedded
+ * as a data: URI instead of being referenced by its path.
+ * Icons given as string literals are looked up when the template is parsed
+ * and their paths are kept by the node. They are looked up again when the
+ * provider is replaced or its IconProvider::revision() changes.
  *
  * @note Support for nested variables inside tags is non-standard for Grantlee
  * tags, but makes it easier to use {% icon %} in sub-templates.
@@ -53,7 +69,17 @@ public:
     void render(KTextTemplate::OutputStream *stream, KTextTemplate::Context *c) const override;
 
 private:
+    QString literalIconPath(const KCalUtils::IncidenceFormatter::IconProvider *icons) const;
+
+    // String literals are unquoted when the template is parsed, variables
+    // are parsed once and resolved on each render
     QString mIconName;
     QString mAltText;
+    KTextTemplate::Variable mIconNameVariable;
+    KTextTemplate::Variable mAltTextVariable;
     int mSizeOrGroup;
+    // Path of the literal icon, valid for mIconProvider at mIconRevision
+    mutable QString mIconPath;
+    mutable const KCalUtils::IncidenceFormatter::IconProvider *mIconProvider = nullptr;
+    mutable quint64 mIconRevision = 0;
 };
@@ -7,6 +7,7 @@
 
 #include "kcalendargrantleeplugin.h"
 #include "datetimefilters.h"
+#include "fragmentcache.h"
 #include "icon.h"
 
 KCalendarGrantleePlugin::KCalendarGrantleePlugin(QObject *parent)
@@ -23,6 +24,7 @@ QHash<QString, KTextTemplate::AbstractNodeFactory *> KCalendarGrantleePlugin::no
     Q_UNUSED(name)
     QHash<QString, KTextTemplate::AbstractNodeFactory *> nodeFactories;
     nodeFactories[QStringLiteral("icon")] = new IconTag();
+    nodeFactories[QStringLiteral("fragmentcache")] = new FragmentCacheTag();
 
     return nodeFactories;
 }
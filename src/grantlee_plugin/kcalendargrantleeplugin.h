@@ -12,7 +12,7 @@ class KCalendarGrantleePlugin : public QObject, public KTextTemplate::TagLibrary
 {
     Q_OBJECT
     Q_INTERFACES(KTextTemplate::TagLibraryInterface)
-    Q_PLUGIN_METADATA(IID "org.kde.KCalendarGrantleePlugin")
+    Q_PLUGIN_METADATA(IID "org.kde.KCalendarGrantleePlugin" FILE "kcalendargrantleeplugin.json")
 
 public:
     explicit KCalendarGrantleePlugin(QObject *parent = nullptr);
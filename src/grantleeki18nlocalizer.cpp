@@ -6,6 +6,7 @@
  */
 
 #include "grantleeki18nlocalizer_p.h"
+#include "formatterstatistics_p.h"
 #include "kcalutils_debug.h"
 
 #include <KTextTemplate/SafeString>
@@ -20,6 +21,67 @@ GrantleeKi18nLocalizer::GrantleeKi18nLocalizer()
 
 GrantleeKi18nLocalizer::~GrantleeKi18nLocalizer()
 {
+    KCalUtils::FormatterStatistics::addCacheMemory(-mCacheMemory);
+}
+
+void GrantleeKi18nLocalizer::clearCache() const
+{
+    mMessages.clear();
+    mTranslations.clear();
+    KCalUtils::FormatterStatistics::addCacheMemory(-mCacheMemory);
+    mCacheMemory = 0;
+}
+
+QString GrantleeKi18nLocalizer::localize(MessageKind kind,
+                                         const QString &string,
+                                         const QString &pluralForm,
+                                         const QString &context,
+                                         const QVariantList &arguments) const
+{
+    const QStringList languages = KLocalizedString::languages();
+    if (languages != mLanguages) {
+        clearCache();
+        mLanguages = languages;
+    }
+
+    // Joined with the separator gettext puts between context and message
+    const QString key = QString::number(kind) + QChar(4) + context + QChar(4) + string + QChar(4) + pluralForm;
+    if (arguments.isEmpty()) {
+        const auto it = mTranslations.constFind(key);
+        if (it != mTranslations.constEnd()) {
+            return *it;
+        }
+    }
+
+    auto it = mMessages.constFind(key);
+    if (it == mMessages.constEnd()) {
+        KLocalizedString str;
+        switch (kind) {
+        case Message:
+            str = kxi18n(qPrintable(string));
+            break;
+        case ContextMessage:
+            str = kxi18nc(qPrintable(context), qPrintable(string));
+            break;
+        case PluralMessage:
+            str = kxi18np(qPrintable(string), qPrintable(pluralForm));
+            break;
+        case PluralContextMessage:
+            str = kxi18ncp(qPrintable(context), qPrintable(string), qPrintable(pluralForm));
+            break;
+        }
+        it = mMessages.insert(key, str);
+        mCacheMemory += 2 * key.size() * qint64(sizeof(QChar));
+        KCalUtils::FormatterStatistics::addCacheMemory(2 * key.size() * qint64(sizeof(QChar)));
+    }
+
+    const QString result = processArguments(*it, arguments);
+    if (arguments.isEmpty()) {
+        mTranslations.insert(key, result);
+        mCacheMemory += (key.size() + result.size()) * qint64(sizeof(QChar));
+        KCalUtils::FormatterStatistics::addCacheMemory((key.size() + result.size()) * qint64(sizeof(QChar)));
+    }
+    return result;
 }
 
 QString GrantleeKi18nLocalizer::processArguments(const KLocalizedString &kstr, const QVariantList &arguments) const
@@ -66,14 +128,12 @@ QString GrantleeKi18nLocalizer::processArguments(const KLocalizedString &kstr, c
 
 QString GrantleeKi18nLocalizer::localizeContextString(const QString &string, const QString &context, const QVariantList &arguments) const
 {
-    const KLocalizedString str = kxi18nc(qPrintable(context), qPrintable(string));
-    return processArguments(str, arguments);
+    return localize(ContextMessage, string, QString(), context, arguments);
 }
 
 QString GrantleeKi18nLocalizer::localizeString(const QString &string, const QVariantList &arguments) const
 {
-    const KLocalizedString str = kxi18n(qPrintable(string));
-    return processArguments(str, arguments);
+    return localize(Message, string, QString(), QString(), arguments);
 }
 
 QString GrantleeKi18nLocalizer::localizePluralContextString(const QString &string,
@@ -81,14 +141,12 @@ QString GrantleeKi18nLocalizer::localizePluralContextString(const QString &strin
                                                             const QString &context,
                                                             const QVariantList &arguments) const
 {
-    const KLocalizedString str = kxi18ncp(qPrintable(context), qPrintable(string), qPrintable(pluralForm));
-    return processArguments(str, arguments);
+    return localize(PluralContextMessage, string, pluralForm, context, arguments);
 }
 
 QString GrantleeKi18nLocalizer::localizePluralString(const QString &string, const QString &pluralForm, const QVariantList &arguments) const
 {
-    const KLocalizedString str = kxi18np(qPrintable(string), qPrintable(pluralForm));
-    return processArguments(str, arguments);
+    return localize(PluralMessage, string, pluralForm, QString(), arguments);
 }
 
 QString GrantleeKi18nLocalizer::localizeMonetaryValue(qreal value, const QString &currencySymbol) const
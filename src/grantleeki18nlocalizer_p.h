@@ -6,13 +6,24 @@
  */
 
 #pragma once
+#include "kcalutils_private_export.h"
+
 #include <KTextTemplate/QtLocalizer>
 #include <QObject>
 
+#include <KLocalizedString>
+#include <QHash>
 #include <QLocale>
+#include <QStringList>
 
-class KLocalizedString;
-class GrantleeKi18nLocalizer : public KTextTemplate::QtLocalizer
+/**
+ * Localizer of the {% i18n %} tags, using the translations of kcalutils.
+ *
+ * The messages are created once and kept, and the translations of messages
+ * without arguments are remembered, until the languages of KLocalizedString
+ * change. Each template manager has its own localizer, used by one thread.
+ */
+class KCALUTILS_TESTS_EXPORT GrantleeKi18nLocalizer : public KTextTemplate::QtLocalizer
 {
 public:
     explicit GrantleeKi18nLocalizer();
@@ -31,5 +42,20 @@ public:
     [[nodiscard]] QString localizeMonetaryValue(qreal value, const QString &currenctCode) const override;
 
 private:
+    enum MessageKind {
+        Message,
+        ContextMessage,
+        PluralMessage,
+        PluralContextMessage,
+    };
+
+    [[nodiscard]] QString
+    localize(MessageKind kind, const QString &string, const QString &pluralForm, const QString &context, const QVariantList &arguments) const;
     [[nodiscard]] QString processArguments(const KLocalizedString &str, const QVariantList &arguments) const;
+    void clearCache() const;
+
+    mutable QStringList mLanguages;
+    mutable QHash<QString, KLocalizedString> mMessages;
+    mutable QHash<QString, QString> mTranslations;
+    mutable qint64 mCacheMemory = 0;
 };
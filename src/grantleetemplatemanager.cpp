@@ -9,23 +9,76 @@
 
 #include "grantleeki18nlocalizer_p.h"
 #include "grantleetemplatemanager_p.h"
+#include "formatterstatistics_p.h"
 #include "qtresourcetemplateloader.h"
+#include "tracing_p.h"
 
 #include <KTextTemplate/Engine>
 #include <KTextTemplate/Template>
 #include <KTextTemplate/TemplateLoader>
+#include <KTextTemplate/Util>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
 #include <QStandardPaths>
 #include <QString>
+#include <QThread>
+#include <QThreadStorage>
 
 #include <KLocalizedString>
 
-GrantleeTemplateManager *GrantleeTemplateManager::sInstance = nullptr;
+#include <atomic>
+#include <utility>
+
+#if KCALUTILS_STATIC_TEMPLATE_PLUGIN
+#include <QtPlugin>
+
+// The tags and filters are built into the library, the engine finds them
+// among the static plugins instead of searching the plugin paths
+Q_IMPORT_PLUGIN(KCalendarGrantleePlugin)
+#endif
+
+namespace
+{
+// Paths set through setTemplatePath() and setPluginPath(), shared by the
+// managers of all threads. Bumping the generation makes every manager pick
+// them up again on its next render().
+struct SharedSettings {
+    QMutex mutex;
+    QString templatePath;
+    QStringList pluginPaths;
+    std::atomic<quint64> generation{0};
+};
+
+SharedSettings &sharedSettings()
+{
+    static SharedSettings settings;
+    return settings;
+}
+// Manager prepared by prepare(), waiting for its thread to take it over
+struct PreparedManager {
+    QMutex mutex;
+    GrantleeTemplateManager *manager = nullptr;
+    QPointer<QThread> thread;
+};
+
+PreparedManager &preparedManager()
+{
+    static PreparedManager prepared;
+    return prepared;
+}
+}
 
 GrantleeTemplateManager::GrantleeTemplateManager()
     : mEngine(new KTextTemplate::Engine)
     , mLoader(new KCalUtils::QtResourceTemplateLoader)
     , mLocalizer(new GrantleeKi18nLocalizer)
+#if KCALUTILS_STATIC_TEMPLATE_PLUGIN
+    , mDefaultPluginPaths(mEngine->pluginPaths())
+#else
+    , mDefaultPluginPaths(QStringList{QStringLiteral(GRANTLEE_PLUGIN_INSTALL_DIR)} + mEngine->pluginPaths())
+#endif
 {
     const QString path = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kcalendar/templates"), QStandardPaths::LocateDirectory);
     if (!path.isEmpty()) {
@@ -34,10 +87,11 @@ GrantleeTemplateManager::GrantleeTemplateManager()
     }
 
     mEngine->addTemplateLoader(mLoader);
-    mEngine->addPluginPath(QStringLiteral(GRANTLEE_PLUGIN_INSTALL_DIR));
+    mEngine->setPluginPaths(mDefaultPluginPaths);
     mEngine->addDefaultLibrary(QStringLiteral("ktexttemplate_i18ntags"));
     mEngine->addDefaultLibrary(QStringLiteral("kcalendar_grantlee_plugin"));
     mEngine->setSmartTrimEnabled(true);
+    applySharedSettings();
 }
 
 GrantleeTemplateManager::~GrantleeTemplateManager()
@@ -47,59 +101,151 @@ GrantleeTemplateManager::~GrantleeTemplateManager()
 
 GrantleeTemplateManager *GrantleeTemplateManager::instance()
 {
-    if (!sInstance) {
-        sInstance = new GrantleeTemplateManager;
+    static QThreadStorage<GrantleeTemplateManager *> instances;
+    if (!instances.hasLocalData()) {
+        GrantleeTemplateManager *manager = nullptr;
+        PreparedManager &prepared = preparedManager();
+        {
+            QMutexLocker locker(&prepared.mutex);
+            if (prepared.manager && prepared.thread == QThread::currentThread()) {
+                manager = std::exchange(prepared.manager, nullptr);
+            }
+        }
+        if (!manager) {
+            manager = new GrantleeTemplateManager;
+        }
+        instances.setLocalData(manager);
+    }
+    return instances.localData();
+}
+
+void GrantleeTemplateManager::prepare(const QStringList &templateNames, QThread *thread)
+{
+    PreparedManager &prepared = preparedManager();
+    {
+        QMutexLocker locker(&prepared.mutex);
+        if (prepared.manager) {
+            return;
+        }
+    }
+
+    auto manager = new GrantleeTemplateManager;
+    for (const QString &templateName : templateNames) {
+        KCalUtils::Tracing::TraceSpan span("loadTemplate", templateName);
+        if (manager->mLoader->canLoadTemplate(templateName)) {
+            const KTextTemplate::Template tpl = manager->mLoader->loadByName(templateName, manager->mEngine);
+            Q_UNUSED(tpl)
+        }
+    }
+    // The engine, the templates and their nodes are QObjects, they are
+    // pushed to the thread that will render with them
+    manager->mEngine->moveToThread(thread);
+    manager->mLoader->moveToThread(thread);
+
+    QMutexLocker locker(&prepared.mutex);
+    if (prepared.manager) {
+        locker.unlock();
+        delete manager;
+        return;
+    }
+    prepared.manager = manager;
+    prepared.thread = thread;
+}
+
+void GrantleeTemplateManager::applySharedSettings() const
+{
+    SharedSettings &settings = sharedSettings();
+    const quint64 generation = settings.generation.load(std::memory_order_acquire);
+    if (generation == mSettingsGeneration) {
+        return;
+    }
+
+    QMutexLocker locker(&settings.mutex);
+    if (!settings.templatePath.isEmpty()) {
+        mLoader->setTemplateDirs({settings.templatePath});
+        mLoader->setTheme(QString());
     }
-    return sInstance;
+    mEngine->setPluginPaths(settings.pluginPaths + mDefaultPluginPaths);
+    mSettingsGeneration = settings.generation.load(std::memory_order_relaxed);
+    locker.unlock();
+
+    mLoader->clearCache();
 }
 
 void GrantleeTemplateManager::setTemplatePath(const QString &path)
 {
-    mLoader->setTemplateDirs({path});
-    mLoader->setTheme(QString());
+    SharedSettings &settings = sharedSettings();
+    {
+        QMutexLocker locker(&settings.mutex);
+        settings.templatePath = path;
+        settings.generation.fetch_add(1, std::memory_order_release);
+    }
+    applySharedSettings();
 }
 
 void GrantleeTemplateManager::setPluginPath(const QString &path)
 {
-    QStringList pluginPaths = mEngine->pluginPaths();
-    pluginPaths.prepend(path);
-    mEngine->setPluginPaths(pluginPaths);
+    SharedSettings &settings = sharedSettings();
+    {
+        QMutexLocker locker(&settings.mutex);
+        settings.pluginPaths.prepend(path);
+        settings.generation.fetch_add(1, std::memory_order_release);
+    }
+    applySharedSettings();
 }
 KTextTemplate::Context GrantleeTemplateManager::createContext(const QVariantHash &hash) const
 {
     KTextTemplate::Context ctx;
     ctx.insert(QStringLiteral("incidence"), hash);
     ctx.setLocalizer(mLocalizer);
+    // Part of the keys of {% fragmentcache %}, looked up once per render
+    ctx.insert(QStringLiteral("kcalutilsLocaleKey"), mLocalizer->currentLocale() + QLatin1Char(';') + KLocalizedString::languages().join(QLatin1Char(',')));
     return ctx;
 }
 
 QString GrantleeTemplateManager::errorTemplate(const QString &reason, const QString &origTemplateName, const KTextTemplate::Template &failedTemplate) const
 {
-    KTextTemplate::Template tpl = mEngine->newTemplate(QStringLiteral("<h1>{{ error }}</h1>\n"
-                                                                      "<b>%1:</b> {{ templateName }}<br>\n"
-                                                                      "<b>%2:</b> {{ errorMessage }}")
-                                                           .arg(i18n("Template"), i18n("Error message")),
-                                                       QStringLiteral("TemplateError"));
+    // Parsed once, a broken theme fails on every render
+    if (!mErrorTemplate) {
+        mErrorTemplate = mEngine->newTemplate(QStringLiteral("<h1>{{ error }}</h1>\n"
+                                                             "<b>{{ templateLabel }}:</b> {{ templateName }}<br>\n"
+                                                             "<b>{{ errorMessageLabel }}:</b> {{ errorMessage }}"),
+                                              QStringLiteral("TemplateError"));
+    }
 
     KTextTemplate::Context ctx = createContext();
     ctx.insert(QStringLiteral("error"), reason);
+    ctx.insert(QStringLiteral("templateLabel"), QVariant::fromValue(KTextTemplate::markSafe(i18n("Template"))));
     ctx.insert(QStringLiteral("templateName"), origTemplateName);
+    ctx.insert(QStringLiteral("errorMessageLabel"), QVariant::fromValue(KTextTemplate::markSafe(i18n("Error message"))));
     ctx.insert(QStringLiteral("errorMessage"), failedTemplate->errorString());
-    return tpl->render(&ctx);
+    return mErrorTemplate->render(&ctx);
 }
 
 QString GrantleeTemplateManager::render(const QString &templateName, const QVariantHash &data) const
 {
+    KCalUtils::Tracing::TraceSpan span("render", templateName);
+    KCalUtils::FormatterStatistics::PhaseTimer timer(KCalUtils::FormatterStatistics::Statistics::RenderPhase);
+    applySharedSettings();
     if (!mLoader->canLoadTemplate(templateName)) {
         qWarning() << "Cannot load template" << templateName << ", please check your installation";
         return QString();
     }
+    KCalUtils::Tracing::TraceSpan loadSpan("loadTemplate", templateName);
     KTextTemplate::Template tpl = mLoader->loadByName(templateName, mEngine);
+    loadSpan.end();
+    if (!tpl) {
+        // Removed since it was found
+        qWarning() << "Cannot load template" << templateName << ", please check your installation";
+        return QString();
+    }
     if (tpl->error()) {
         return errorTemplate(i18n("Template parsing error"), templateName, tpl);
     }
+    KCalUtils::Tracing::TraceSpan renderSpan("renderTemplate", templateName);
     KTextTemplate::Context ctx = createContext(data);
     const QString result = tpl->render(&ctx);
+    renderSpan.end();
     if (tpl->error()) {
         return errorTemplate(i18n("Template rendering error"), templateName, tpl);
     }
@@ -9,20 +9,34 @@
 
 #include "kcalutils_private_export.h"
 #include <QSharedPointer>
+#include <QStringList>
 #include <QVariantHash>
 
 namespace KTextTemplate
 {
 class Engine;
-class FileSystemTemplateLoader;
 class TemplateImpl;
 class Context;
 using Template = QSharedPointer<TemplateImpl>;
 }
 
+namespace KCalUtils
+{
+class QtResourceTemplateLoader;
+}
+
 class QString;
+class QThread;
 class GrantleeKi18nLocalizer;
 
+/**
+  Renders the calendar templates.
+
+  Each thread gets its own manager (and KTextTemplate engine), as the engine
+  and the templates it parses must not be shared between threads.
+  The template and plugin paths are shared: changing them from any thread
+  applies to the managers of all threads before their next render().
+*/
 class KCALUTILS_TESTS_EXPORT GrantleeTemplateManager
 {
 public:
@@ -35,15 +49,27 @@ public:
 
     [[nodiscard]] QString render(const QString &templateName, const QVariantHash &data) const;
 
+    /**
+      Creates a manager and parses @p templateNames on the calling thread,
+      then hands the engine and the parsed templates over to @p thread.
+      The manager is taken over when @p thread first calls instance();
+      other threads keep creating their own.
+    */
+    static void prepare(const QStringList &templateNames, QThread *thread);
+
 private:
     Q_DISABLE_COPY(GrantleeTemplateManager)
     GrantleeTemplateManager();
     QString errorTemplate(const QString &reason, const QString &origTemplateName, const KTextTemplate::Template &failedTemplate) const;
     KTextTemplate::Context createContext(const QVariantHash &hash = QVariantHash()) const;
+    void applySharedSettings() const;
     KTextTemplate::Engine *const mEngine;
-    QSharedPointer<KTextTemplate::FileSystemTemplateLoader> mLoader;
+    QSharedPointer<KCalUtils::QtResourceTemplateLoader> mLoader;
 
     QSharedPointer<GrantleeKi18nLocalizer> mLocalizer;
 
-    static GrantleeTemplateManager *sInstance;
+    mutable KTextTemplate::Template mErrorTemplate;
+
+    const QStringList mDefaultPluginPaths;
+    mutable quint64 mSettingsGeneration = 0;
 };
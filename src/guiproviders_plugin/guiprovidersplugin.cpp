@@ -0,0 +1,112 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "guiprovidersplugin.h"
+
+#include <KIconLoader>
+
+#include <QEvent>
+#include <QGuiApplication>
+#include <QMutexLocker>
+#include <QPalette>
+
+using namespace KCalUtils::IncidenceFormatter;
+
+QString PaletteColorProvider::color(ColorRole role) const
+{
+    QMutexLocker locker(&mMutex);
+    if (role != DiffColor && !mColors[role].isEmpty()) {
+        return mColors[role];
+    }
+    locker.unlock();
+    return ColorProvider::color(role);
+}
+
+void PaletteColorProvider::update()
+{
+    QPalette p = QGuiApplication::palette();
+    const QString noteColor = p.color(QPalette::Active, QPalette::Highlight).name();
+    p.setCurrentColorGroup(QPalette::Normal);
+
+    QMutexLocker locker(&mMutex);
+    mColors[NoteColor] = noteColor;
+    mColors[ButtonBackgroundColor] = p.color(QPalette::Button).name();
+    mColors[ButtonBorderColor] = p.shadow().color().name();
+    mColors[ButtonTextColor] = p.color(QPalette::ButtonText).name();
+}
+
+QString IconLoaderProvider::iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const
+{
+    // KIconLoader::global() is not reentrant, templates may be rendered from several threads
+    QMutexLocker locker(&mMutex);
+    QHash<std::pair<QString, int>, QString> &paths = mPaths[canReturnNull];
+    const std::pair<QString, int> key(name, sizeOrGroup);
+    auto it = paths.constFind(key);
+    if (it == paths.constEnd()) {
+        it = paths.insert(key, KIconLoader::global()->iconPath(name, sizeOrGroup, canReturnNull));
+    }
+    return *it;
+}
+
+int IconLoaderProvider::iconSize(int sizeOrGroup) const
+{
+    if (sizeOrGroup < KIconLoader::FirstGroup || sizeOrGroup >= KIconLoader::LastGroup) {
+        return sizeOrGroup;
+    }
+    QMutexLocker locker(&mMutex);
+    auto it = mSizes.constFind(sizeOrGroup);
+    if (it == mSizes.constEnd()) {
+        it = mSizes.insert(sizeOrGroup, KIconLoader::global()->currentSize(static_cast<KIconLoader::Group>(sizeOrGroup)));
+    }
+    return *it;
+}
+
+void IconLoaderProvider::clearCache()
+{
+    QMutexLocker locker(&mMutex);
+    mPaths[false].clear();
+    mPaths[true].clear();
+    mSizes.clear();
+    locker.unlock();
+    iconsChanged();
+}
+
+GuiProvidersPlugin::GuiProvidersPlugin(QObject *parent)
+    : QObject(parent)
+{
+    // The plugin is loaded on the application thread, which owns the palette
+    mColorProvider.update();
+    qGuiApp->installEventFilter(this);
+
+    // Clearing the cache is thread-safe, so connect directly
+    const auto clearIconCache = [this]() {
+        mIconProvider.clearCache();
+    };
+    connect(KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged, this, clearIconCache, Qt::DirectConnection);
+    connect(KIconLoader::global(), &KIconLoader::iconChanged, this, clearIconCache, Qt::DirectConnection);
+}
+
+GuiProvidersPlugin::~GuiProvidersPlugin() = default;
+
+bool GuiProvidersPlugin::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == qGuiApp && event->type() == QEvent::ApplicationPaletteChange) {
+        mColorProvider.update();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+ColorProvider *GuiProvidersPlugin::colorProvider()
+{
+    return &mColorProvider;
+}
+
+IconProvider *GuiProvidersPlugin::iconProvider()
+{
+    return &mIconProvider;
+}
+
+#include "moc_guiprovidersplugin.cpp"
@@ -0,0 +1,66 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "../guiprovidersinterface_p.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+// Takes the colors from the application palette. They are read on the
+// application thread and kept until the palette changes, so other threads
+// do not touch the palette.
+class PaletteColorProvider : public KCalUtils::IncidenceFormatter::ColorProvider
+{
+public:
+    [[nodiscard]] QString color(ColorRole role) const override;
+
+    void update();
+
+private:
+    mutable QMutex mMutex;
+    QString mColors[ButtonTextColor + 1];
+};
+
+// Looks the icons up in the current icon theme. The results are cached until
+// the icon theme or the icon sizes change.
+class IconLoaderProvider : public KCalUtils::IncidenceFormatter::IconProvider
+{
+public:
+    [[nodiscard]] QString iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const override;
+    [[nodiscard]] int iconSize(int sizeOrGroup) const override;
+
+    void clearCache();
+
+private:
+    mutable QMutex mMutex;
+    // Paths by icon name and size or group, for canReturnNull false and true
+    mutable QHash<std::pair<QString, int>, QString> mPaths[2];
+    mutable QHash<int, int> mSizes;
+};
+
+class GuiProvidersPlugin : public QObject, public KCalUtils::GuiProvidersInterface
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID KCalUtilsGuiProvidersInterface_iid)
+    Q_INTERFACES(KCalUtils::GuiProvidersInterface)
+
+public:
+    explicit GuiProvidersPlugin(QObject *parent = nullptr);
+    ~GuiProvidersPlugin() override;
+
+    [[nodiscard]] KCalUtils::IncidenceFormatter::ColorProvider *colorProvider() override;
+    [[nodiscard]] KCalUtils::IncidenceFormatter::IconProvider *iconProvider() override;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    PaletteColorProvider mColorProvider;
+    IconLoaderProvider mIconProvider;
+};
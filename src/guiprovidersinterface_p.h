@@ -0,0 +1,31 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceformatter.h"
+
+#include <QtPlugin>
+
+namespace KCalUtils
+{
+/**
+  Implemented by the plugin that provides the colors of the application
+  palette and the icons of KIconLoader. The core library has no GUI
+  dependency and only loads it in applications with a QGuiApplication.
+*/
+class GuiProvidersInterface
+{
+public:
+    virtual ~GuiProvidersInterface() = default;
+
+    [[nodiscard]] virtual IncidenceFormatter::ColorProvider *colorProvider() = 0;
+    [[nodiscard]] virtual IncidenceFormatter::IconProvider *iconProvider() = 0;
+};
+}
+
+#define KCalUtilsGuiProvidersInterface_iid "org.kde.pim.kcalutils.GuiProvidersInterface"
+Q_DECLARE_INTERFACE(KCalUtils::GuiProvidersInterface, KCalUtilsGuiProvidersInterface_iid)
@@ -0,0 +1,400 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-FileCopyrightText: 2000-2003 Cornelius Schumacher <schumacher@kde.org>
+  SPDX-FileCopyrightText: 2004 Reinhold Kainhofer <reinhold@kainhofer.com>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#include "htmlexport.h"
+#include "grantleetemplatemanager_p.h"
+#include "htmlexportsettings.h"
+#include "kcalutils_debug.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/Todo>
+using namespace KCalendarCore;
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLocale>
+
+using namespace KCalUtils;
+
+namespace
+{
+// Number of to-dos rendered in one go; keeps the rendered page small no
+// matter how many to-dos the calendar holds.
+constexpr int todosPerPage = 100;
+}
+
+//@cond PRIVATE
+class KCalUtils::HtmlExportPrivate
+{
+public:
+    HtmlExportPrivate(const Calendar::Ptr &calendar, HTMLExportSettings *settings)
+        : mCalendar(calendar)
+        , mSettings(settings)
+    {
+    }
+
+    [[nodiscard]] QString fileNameForIndex(int index) const;
+    [[nodiscard]] bool openFile();
+    [[nodiscard]] bool closeFile(bool more);
+    [[nodiscard]] bool writePage(const QString &templateName, const QVariantHash &data, int incidenceCount);
+
+    [[nodiscard]] bool exportMonths();
+    [[nodiscard]] bool exportWeeks();
+    [[nodiscard]] bool exportTodos();
+
+    [[nodiscard]] bool checkSecrecy(const Incidence::Ptr &incidence) const;
+    void collectEvents(QDate first, QDate last);
+    void addEventDays(const Event::Ptr &event, const QDateTime &start, const QDateTime &end, QDate first, QDate last);
+    [[nodiscard]] QVariantList eventsForDate(QDate date, int &count) const;
+    [[nodiscard]] QVariantHash todoHash(const Todo::Ptr &todo) const;
+
+    Calendar::Ptr mCalendar;
+    HTMLExportSettings *const mSettings;
+    QString mBaseFileName;
+    QFile mFile;
+    QStringList mOutputFiles;
+    int mIncidencesInFile = 0;
+    // Events of each day of the page being exported, see collectEvents()
+    QHash<QDate, Event::List> mEventsByDate;
+};
+//@endcond
+
+QString HtmlExportPrivate::fileNameForIndex(int index) const
+{
+    if (index == 0) {
+        return mBaseFileName;
+    }
+    const QFileInfo info(mBaseFileName);
+    QString name = info.completeBaseName() + QLatin1Char('-') + QString::number(index + 1);
+    if (!info.suffix().isEmpty()) {
+        name += QLatin1Char('.') + info.suffix();
+    }
+    return info.dir().filePath(name);
+}
+
+bool HtmlExportPrivate::openFile()
+{
+    const int index = mOutputFiles.count();
+    mFile.setFileName(fileNameForIndex(index));
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KCALUTILS_LOG) << "Unable to open" << mFile.fileName() << "for writing:" << mFile.errorString();
+        return false;
+    }
+    mOutputFiles.append(mFile.fileName());
+    mIncidencesInFile = 0;
+
+    QVariantHash header;
+    header[QStringLiteral("title")] = mSettings->title();
+    header[QStringLiteral("part")] = index + 1;
+    if (index > 0) {
+        header[QStringLiteral("previous")] = QFileInfo(fileNameForIndex(index - 1)).fileName();
+    }
+    return mFile.write(GrantleeTemplateManager::instance()->render(QStringLiteral(":/htmlexport_header.html"), header).toUtf8()) >= 0;
+}
+
+bool HtmlExportPrivate::closeFile(bool more)
+{
+    const int index = mOutputFiles.count() - 1;
+    QVariantHash footer;
+    if (index > 0) {
+        footer[QStringLiteral("previous")] = QFileInfo(fileNameForIndex(index - 1)).fileName();
+    }
+    if (more) {
+        footer[QStringLiteral("next")] = QFileInfo(fileNameForIndex(index + 1)).fileName();
+    }
+    const bool ok = mFile.write(GrantleeTemplateManager::instance()->render(QStringLiteral(":/htmlexport_footer.html"), footer).toUtf8()) >= 0;
+    mFile.close();
+    return ok && mFile.error() == QFileDevice::NoError;
+}
+
+bool HtmlExportPrivate::writePage(const QString &templateName, const QVariantHash &data, int incidenceCount)
+{
+    const int max = mSettings->maxIncidencesPerFile();
+    if (max > 0 && mIncidencesInFile > 0 && mIncidencesInFile + incidenceCount > max) {
+        if (!closeFile(true) || !openFile()) {
+            return false;
+        }
+    }
+
+    if (mFile.write(GrantleeTemplateManager::instance()->render(templateName, data).toUtf8()) < 0) {
+        qCWarning(KCALUTILS_LOG) << "Unable to write to" << mFile.fileName() << ":" << mFile.errorString();
+        return false;
+    }
+    mIncidencesInFile += incidenceCount;
+    return true;
+}
+
+bool HtmlExportPrivate::checkSecrecy(const Incidence::Ptr &incidence) const
+{
+    const Incidence::Secrecy secrecy = incidence->secrecy();
+    if (secrecy == Incidence::SecrecyPublic) {
+        return true;
+    }
+    if (secrecy == Incidence::SecrecyPrivate && !mSettings->excludePrivate()) {
+        return true;
+    }
+    if (secrecy == Incidence::SecrecyConfidential && !mSettings->excludeConfidential()) {
+        return true;
+    }
+    return false;
+}
+
+void HtmlExportPrivate::collectEvents(QDate first, QDate last)
+{
+    // The calendar goes through all of its events for every day it is asked
+    // about, so the events of a page are fetched once and sorted into days.
+    // Only one page is held at a time, however long the exported range is.
+    mEventsByDate.clear();
+    const QTimeZone timeZone = QTimeZone::systemTimeZone();
+    const Event::List events = Calendar::sortEvents(mCalendar->events(first, last, timeZone, false), EventSortStartDate, SortDirectionAscending);
+    for (const Event::Ptr &event : events) {
+        if (!event->recurs()) {
+            addEventDays(event, event->dtStart(), event->dtEnd(), first, last);
+            continue;
+        }
+        // Occurrences starting before the range may last into it
+        const qint64 duration = event->dtStart().secsTo(event->dtEnd());
+        const QDateTime from(first.addDays(-(duration / 86400) - 1), QTime(0, 0), timeZone);
+        const QDateTime to(last, QTime(23, 59, 59), timeZone);
+        const auto occurrences = event->recurrence()->timesInInterval(from, to);
+        for (const QDateTime &start : occurrences) {
+            addEventDays(event, start, start.addSecs(duration), first, last);
+        }
+    }
+}
+
+void HtmlExportPrivate::addEventDays(const Event::Ptr &event, const QDateTime &start, const QDateTime &end, QDate first, QDate last)
+{
+    QDate startDate;
+    QDate endDate;
+    if (event->allDay()) {
+        // The end date of all-day events is inclusive
+        startDate = start.date();
+        endDate = end.date();
+    } else {
+        const QTimeZone timeZone = QTimeZone::systemTimeZone();
+        const QDateTime localStart = start.toTimeZone(timeZone);
+        const QDateTime localEnd = end.toTimeZone(timeZone);
+        startDate = localStart.date();
+        // An event ending at midnight does not take place on the next day
+        endDate = localEnd > localStart ? localEnd.addSecs(-1).date() : startDate;
+    }
+    for (QDate day = qMax(startDate, first), lastDay = qMin(endDate, last); day <= lastDay; day = day.addDays(1)) {
+        Event::List &dayEvents = mEventsByDate[day];
+        // Recurring events may have several occurrences on one day
+        if (dayEvents.isEmpty() || dayEvents.constLast() != event) {
+            dayEvents.append(event);
+        }
+    }
+}
+
+QVariantList HtmlExportPrivate::eventsForDate(QDate date, int &count) const
+{
+    QVariantList events;
+    const Event::List dayEvents = mEventsByDate.value(date);
+    for (const Event::Ptr &event : dayEvents) {
+        if (!checkSecrecy(event)) {
+            continue;
+        }
+        QVariantHash hash;
+        hash[QStringLiteral("summary")] = event->richSummary();
+        if (!event->allDay()) {
+            const QDateTime start = event->dtStart().toLocalTime();
+            // Only show the start time on the day the (occurrence of the) event starts
+            if (event->recurs() ? event->recursOn(date, QTimeZone::systemTimeZone()) : start.date() == date) {
+                hash[QStringLiteral("time")] = start.time();
+            }
+        }
+        if (mSettings->eventLocation()) {
+            hash[QStringLiteral("location")] = event->richLocation();
+        }
+        if (mSettings->eventCategories()) {
+            hash[QStringLiteral("categories")] = event->categories();
+        }
+        events.push_back(hash);
+        ++count;
+    }
+    return events;
+}
+
+QVariantHash HtmlExportPrivate::todoHash(const Todo::Ptr &todo) const
+{
+    QVariantHash hash;
+    hash[QStringLiteral("summary")] = todo->richSummary();
+    hash[QStringLiteral("priority")] = todo->priority();
+    hash[QStringLiteral("percent")] = todo->percentComplete();
+    hash[QStringLiteral("completed")] = todo->isCompleted();
+    if (todo->hasDueDate()) {
+        const QDateTime due = todo->dtDue().toLocalTime();
+        hash[QStringLiteral("dueDate")] = due.date();
+        if (!todo->allDay()) {
+            hash[QStringLiteral("dueTime")] = due.time();
+        }
+    }
+    if (mSettings->eventCategories()) {
+        hash[QStringLiteral("categories")] = todo->categories();
+    }
+    return hash;
+}
+
+bool HtmlExportPrivate::exportMonths()
+{
+    const QLocale locale;
+    const int weekStart = locale.firstDayOfWeek();
+
+    QVariantList dayNames;
+    for (int i = 0; i < 7; ++i) {
+        dayNames.push_back(locale.dayName((weekStart + i - 1) % 7 + 1, QLocale::ShortFormat));
+    }
+
+    QDate month(mSettings->dateStart().year(), mSettings->dateStart().month(), 1);
+    const QDate end = mSettings->dateEnd();
+    while (month <= end) {
+        const QDate nextMonth = month.addMonths(1);
+        collectEvents(month, nextMonth.addDays(-1));
+        QDate day = month.addDays(-((month.dayOfWeek() - weekStart + 7) % 7));
+
+        int count = 0;
+        QVariantList weeks;
+        while (day < nextMonth) {
+            QVariantList week;
+            for (int i = 0; i < 7; ++i, day = day.addDays(1)) {
+                QVariantHash dayHash;
+                dayHash[QStringLiteral("dayNumber")] = day.day();
+                dayHash[QStringLiteral("inMonth")] = day.month() == month.month();
+                if (day.month() == month.month()) {
+                    dayHash[QStringLiteral("events")] = eventsForDate(day, count);
+                }
+                week.push_back(dayHash);
+            }
+            weeks.push_back(QVariant(week));
+        }
+
+        QVariantHash page;
+        page[QStringLiteral("title")] = locale.standaloneMonthName(month.month()) + QLatin1Char(' ') + QString::number(month.year());
+        page[QStringLiteral("dayNames")] = dayNames;
+        page[QStringLiteral("weeks")] = weeks;
+        const bool ok = writePage(QStringLiteral(":/htmlexport_month.html"), page, count);
+        mEventsByDate.clear();
+        if (!ok) {
+            return false;
+        }
+        month = nextMonth;
+    }
+    return true;
+}
+
+bool HtmlExportPrivate::exportWeeks()
+{
+    const int weekStart = QLocale().firstDayOfWeek();
+    const QDate end = mSettings->dateEnd();
+    QDate day = mSettings->dateStart();
+    day = day.addDays(-((day.dayOfWeek() - weekStart + 7) % 7));
+
+    while (day <= end) {
+        int count = 0;
+        QVariantList days;
+        const QDate first = day;
+        collectEvents(first, first.addDays(6));
+        for (int i = 0; i < 7; ++i, day = day.addDays(1)) {
+            QVariantHash dayHash;
+            dayHash[QStringLiteral("date")] = day;
+            dayHash[QStringLiteral("events")] = eventsForDate(day, count);
+            days.push_back(dayHash);
+        }
+
+        QVariantHash page;
+        page[QStringLiteral("weekNumber")] = first.weekNumber();
+        page[QStringLiteral("days")] = days;
+        const bool ok = writePage(QStringLiteral(":/htmlexport_week.html"), page, count);
+        mEventsByDate.clear();
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HtmlExportPrivate::exportTodos()
+{
+    const Todo::List todos = mCalendar->todos(TodoSortDueDate, SortDirectionAscending);
+
+    QVariantList page;
+    page.reserve(todosPerPage);
+    bool first = true;
+    const auto flush = [&]() {
+        QVariantHash data;
+        data[QStringLiteral("first")] = first;
+        data[QStringLiteral("todos")] = page;
+        const bool ok = writePage(QStringLiteral(":/htmlexport_todos.html"), data, page.count());
+        page.clear();
+        first = false;
+        return ok;
+    };
+
+    for (const Todo::Ptr &todo : todos) {
+        if (!checkSecrecy(todo)) {
+            continue;
+        }
+        page.push_back(todoHash(todo));
+        if (page.count() == todosPerPage && !flush()) {
+            return false;
+        }
+    }
+    if (page.isEmpty() && !first) {
+        return true;
+    }
+    return flush();
+}
+
+HtmlExport::HtmlExport(const Calendar::Ptr &calendar, HTMLExportSettings *settings)
+    : d(new KCalUtils::HtmlExportPrivate(calendar, settings))
+{
+}
+
+HtmlExport::~HtmlExport() = default;
+
+bool HtmlExport::save(const QString &fileName)
+{
+    d->mOutputFiles.clear();
+    d->mBaseFileName = fileName.isEmpty() ? d->mSettings->outputFile() : fileName;
+    if (d->mBaseFileName.isEmpty()) {
+        qCWarning(KCALUTILS_LOG) << "No output file specified for the HTML export";
+        return false;
+    }
+
+    if (!d->openFile()) {
+        return false;
+    }
+
+    bool ok = true;
+    if (d->mSettings->monthView()) {
+        ok = d->exportMonths();
+    }
+    if (ok && d->mSettings->weekView()) {
+        ok = d->exportWeeks();
+    }
+    if (ok && d->mSettings->todoView()) {
+        ok = d->exportTodos();
+    }
+
+    if (!ok) {
+        d->mFile.close();
+        return false;
+    }
+    return d->closeFile(false);
+}
+
+QStringList HtmlExport::outputFiles() const
+{
+    return d->mOutputFiles;
+}
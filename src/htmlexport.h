@@ -0,0 +1,68 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-FileCopyrightText: 2000-2003 Cornelius Schumacher <schumacher@kde.org>
+  SPDX-FileCopyrightText: 2004 Reinhold Kainhofer <reinhold@kainhofer.com>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+/**
+  @file
+  This file is part of the API for handling calendar data and
+  defines the HtmlExport class.
+*/
+#pragma once
+
+#include "kcalutilscore_export.h"
+
+#include <KCalendarCore/Calendar>
+
+#include <QStringList>
+
+#include <memory>
+
+namespace KCalUtils
+{
+class HtmlExportPrivate;
+class HTMLExportSettings;
+
+/**
+  @brief
+  Exports a calendar as static HTML pages.
+
+  The month views, week views and the to-do list are rendered one page at a
+  time through the calendar templates and written to disk right away, so the
+  memory used does not depend on the size of the calendar.
+  Large calendars can be split across several files,
+  see HTMLExportSettings::setMaxIncidencesPerFile().
+*/
+class KCALUTILSCORE_EXPORT HtmlExport
+{
+public:
+    /**
+      Create a new HTML exporter for @p calendar, configured by @p settings.
+      The settings are not owned by the exporter.
+    */
+    HtmlExport(const KCalendarCore::Calendar::Ptr &calendar, HTMLExportSettings *settings);
+    ~HtmlExport();
+
+    /**
+      Writes out the calendar in HTML format.
+      @param fileName the file to write to; HTMLExportSettings::outputFile()
+      is used if empty.
+      @return true on success, false if a file could not be written.
+    */
+    [[nodiscard]] bool save(const QString &fileName = QString());
+
+    /**
+      Returns the files written by the last call to save().
+    */
+    [[nodiscard]] QStringList outputFiles() const;
+
+private:
+    //@cond PRIVATE
+    Q_DISABLE_COPY(HtmlExport)
+    std::unique_ptr<HtmlExportPrivate> const d;
+    //@endcond
+};
+}
@@ -0,0 +1,166 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-FileCopyrightText: 2000-2003 Cornelius Schumacher <schumacher@kde.org>
+  SPDX-FileCopyrightText: 2004 Reinhold Kainhofer <reinhold@kainhofer.com>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#include "htmlexportsettings.h"
+
+#include <KLocalizedString>
+
+using namespace KCalUtils;
+
+//@cond PRIVATE
+class KCalUtils::HTMLExportSettingsPrivate
+{
+public:
+    HTMLExportSettingsPrivate()
+        : mTitle(i18n("Calendar"))
+        , mDateStart(QDate::currentDate())
+        , mDateEnd(mDateStart.addMonths(1))
+    {
+    }
+
+    QString mOutputFile;
+    QString mTitle;
+    QDate mDateStart;
+    QDate mDateEnd;
+    int mMaxIncidencesPerFile = 0;
+    bool mMonthView = true;
+    bool mWeekView = false;
+    bool mTodoView = true;
+    bool mExcludePrivate = true;
+    bool mExcludeConfidential = true;
+    bool mEventLocation = true;
+    bool mEventCategories = true;
+};
+//@endcond
+
+HTMLExportSettings::HTMLExportSettings()
+    : d(new KCalUtils::HTMLExportSettingsPrivate)
+{
+}
+
+HTMLExportSettings::~HTMLExportSettings() = default;
+
+void HTMLExportSettings::setOutputFile(const QString &fileName)
+{
+    d->mOutputFile = fileName;
+}
+
+QString HTMLExportSettings::outputFile() const
+{
+    return d->mOutputFile;
+}
+
+void HTMLExportSettings::setTitle(const QString &title)
+{
+    d->mTitle = title;
+}
+
+QString HTMLExportSettings::title() const
+{
+    return d->mTitle;
+}
+
+void HTMLExportSettings::setDateStart(QDate date)
+{
+    d->mDateStart = date;
+}
+
+QDate HTMLExportSettings::dateStart() const
+{
+    return d->mDateStart;
+}
+
+void HTMLExportSettings::setDateEnd(QDate date)
+{
+    d->mDateEnd = date;
+}
+
+QDate HTMLExportSettings::dateEnd() const
+{
+    return d->mDateEnd;
+}
+
+void HTMLExportSettings::setMonthView(bool enable)
+{
+    d->mMonthView = enable;
+}
+
+bool HTMLExportSettings::monthView() const
+{
+    return d->mMonthView;
+}
+
+void HTMLExportSettings::setWeekView(bool enable)
+{
+    d->mWeekView = enable;
+}
+
+bool HTMLExportSettings::weekView() const
+{
+    return d->mWeekView;
+}
+
+void HTMLExportSettings::setTodoView(bool enable)
+{
+    d->mTodoView = enable;
+}
+
+bool HTMLExportSettings::todoView() const
+{
+    return d->mTodoView;
+}
+
+void HTMLExportSettings::setExcludePrivate(bool exclude)
+{
+    d->mExcludePrivate = exclude;
+}
+
+bool HTMLExportSettings::excludePrivate() const
+{
+    return d->mExcludePrivate;
+}
+
+void HTMLExportSettings::setExcludeConfidential(bool exclude)
+{
+    d->mExcludeConfidential = exclude;
+}
+
+bool HTMLExportSettings::excludeConfidential() const
+{
+    return d->mExcludeConfidential;
+}
+
+void HTMLExportSettings::setEventLocation(bool show)
+{
+    d->mEventLocation = show;
+}
+
+bool HTMLExportSettings::eventLocation() const
+{
+    return d->mEventLocation;
+}
+
+void HTMLExportSettings::setEventCategories(bool show)
+{
+    d->mEventCategories = show;
+}
+
+bool HTMLExportSettings::eventCategories() const
+{
+    return d->mEventCategories;
+}
+
+void HTMLExportSettings::setMaxIncidencesPerFile(int max)
+{
+    d->mMaxIncidencesPerFile = qMax(0, max);
+}
+
+int HTMLExportSettings::maxIncidencesPerFile() const
+{
+    return d->mMaxIncidencesPerFile;
+}
@@ -0,0 +1,122 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-FileCopyrightText: 2000-2003 Cornelius Schumacher <schumacher@kde.org>
+  SPDX-FileCopyrightText: 2004 Reinhold Kainhofer <reinhold@kainhofer.com>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+/**
+  @file
+  This file is part of the API for handling calendar data and
+  defines the HTMLExportSettings class.
+*/
+#pragma once
+
+#include "kcalutilscore_export.h"
+
+#include <QDate>
+#include <QString>
+
+#include <memory>
+
+namespace KCalUtils
+{
+class HTMLExportSettingsPrivate;
+
+/**
+  @brief
+  Settings used by HtmlExport when publishing a calendar as static HTML.
+
+  @see HtmlExport
+*/
+class KCALUTILSCORE_EXPORT HTMLExportSettings
+{
+public:
+    HTMLExportSettings();
+    ~HTMLExportSettings();
+
+    /**
+      Sets the file the calendar is exported to.
+      When the export is split across several files, the additional files
+      are named after this one (e.g. calendar-2.html, calendar-3.html).
+    */
+    void setOutputFile(const QString &fileName);
+    [[nodiscard]] QString outputFile() const;
+
+    /**
+      Sets the title used for the exported pages.
+    */
+    void setTitle(const QString &title);
+    [[nodiscard]] QString title() const;
+
+    /**
+      Sets the first day of the exported date range.
+    */
+    void setDateStart(QDate date);
+    [[nodiscard]] QDate dateStart() const;
+
+    /**
+      Sets the last day of the exported date range.
+    */
+    void setDateEnd(QDate date);
+    [[nodiscard]] QDate dateEnd() const;
+
+    /**
+      Sets whether a month view is exported for each month in the date range.
+    */
+    void setMonthView(bool enable);
+    [[nodiscard]] bool monthView() const;
+
+    /**
+      Sets whether a week view is exported for each week in the date range.
+    */
+    void setWeekView(bool enable);
+    [[nodiscard]] bool weekView() const;
+
+    /**
+      Sets whether the to-do list is exported.
+    */
+    void setTodoView(bool enable);
+    [[nodiscard]] bool todoView() const;
+
+    /**
+      Sets whether incidences marked as private are left out of the export.
+    */
+    void setExcludePrivate(bool exclude);
+    [[nodiscard]] bool excludePrivate() const;
+
+    /**
+      Sets whether incidences marked as confidential are left out of the export.
+    */
+    void setExcludeConfidential(bool exclude);
+    [[nodiscard]] bool excludeConfidential() const;
+
+    /**
+      Sets whether the event location is shown in the week view.
+    */
+    void setEventLocation(bool show);
+    [[nodiscard]] bool eventLocation() const;
+
+    /**
+      Sets whether the event and to-do categories are exported.
+    */
+    void setEventCategories(bool show);
+    [[nodiscard]] bool eventCategories() const;
+
+    /**
+      Sets the maximum number of incidences written to a single file.
+      Once a file holds that many incidences, the export continues in a new
+      file. A single page (one month, one week or one block of to-dos) is
+      never split. 0, the default, writes everything to one file.
+    */
+    void setMaxIncidencesPerFile(int max);
+    [[nodiscard]] int maxIncidencesPerFile() const;
+
+private:
+    //@cond PRIVATE
+    Q_DISABLE_COPY(HTMLExportSettings)
+    std::unique_ptr<HTMLExportSettingsPrivate> const d;
+    //@endcond
+};
+}
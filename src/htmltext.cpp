@@ -0,0 +1,65 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "htmltext_p.h"
+
+using namespace KCalUtils;
+
+QString HtmlText::linesToHtml(QStringView text, QLatin1StringView tag, Options options)
+{
+    QString result;
+    // Room for the tags and a few line breaks or entities
+    result.reserve(text.size() + 2 * tag.size() + 64);
+
+    if (!tag.isEmpty()) {
+        result += QLatin1Char('<');
+        result += tag;
+        result += QLatin1Char('>');
+    }
+
+    const bool escape = options & Escape;
+    bool hasLineBreak = false;
+    qsizetype start = 0;
+    for (qsizetype i = 0, end = text.size(); i < end; ++i) {
+        QLatin1StringView replacement;
+        switch (text[i].unicode()) {
+        case '\n':
+            replacement = QLatin1StringView("<br>");
+            hasLineBreak = true;
+            break;
+        case '<':
+            replacement = escape ? QLatin1StringView("&lt;") : QLatin1StringView();
+            break;
+        case '>':
+            replacement = escape ? QLatin1StringView("&gt;") : QLatin1StringView();
+            break;
+        case '&':
+            replacement = escape ? QLatin1StringView("&amp;") : QLatin1StringView();
+            break;
+        case '"':
+            replacement = escape ? QLatin1StringView("&quot;") : QLatin1StringView();
+            break;
+        default:
+            break;
+        }
+        if (!replacement.isEmpty()) {
+            result += text.sliced(start, i - start);
+            result += replacement;
+            start = i + 1;
+        }
+    }
+    result += text.sliced(start);
+
+    if (hasLineBreak && (options & TrailingBreak)) {
+        result += QLatin1StringView("<br>");
+    }
+    if (!tag.isEmpty()) {
+        result += QLatin1StringView("</");
+        result += tag;
+        result += QLatin1Char('>');
+    }
+    return result;
+}
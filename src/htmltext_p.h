@@ -0,0 +1,37 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kcalutils_private_export.h"
+
+#include <QFlags>
+#include <QString>
+
+namespace KCalUtils
+{
+/**
+  Conversion of multi-line text to HTML.
+*/
+namespace HtmlText
+{
+enum Option {
+    NoOptions = 0,
+    Escape = 1, ///< Escape the characters that have a meaning in HTML
+    TrailingBreak = 2, ///< If there is a line break, end the last line with <br> too
+};
+Q_DECLARE_FLAGS(Options, Option)
+
+/**
+  Converts the line breaks of @p text to <br> and, if @p tag is not empty,
+  wraps the result in <tag>...</tag>. The text is processed in a single
+  pass, so the time taken is linear in its length.
+*/
+[[nodiscard]] KCALUTILS_TESTS_EXPORT QString linesToHtml(QStringView text, QLatin1StringView tag = {}, Options options = NoOptions);
+}
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KCalUtils::HtmlText::Options)
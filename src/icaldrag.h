@@ -8,7 +8,7 @@
 */
 #pragma once
 
-#include "kcalutils_export.h"
+#include "kcalutilscore_export.h"
 
 #include <KCalendarCore/Calendar>
 
@@ -24,21 +24,21 @@ namespace ICalDrag
 /**
   Mime-type of iCalendar
 */
-[[nodiscard]] KCALUTILS_EXPORT QString mimeType();
+[[nodiscard]] KCALUTILSCORE_EXPORT QString mimeType();
 
 /**
   Sets the iCalendar representation as data of the drag object
 */
-[[nodiscard]] KCALUTILS_EXPORT bool populateMimeData(QMimeData *e, const KCalendarCore::Calendar::Ptr &cal);
+[[nodiscard]] KCALUTILSCORE_EXPORT bool populateMimeData(QMimeData *e, const KCalendarCore::Calendar::Ptr &cal);
 
 /**
   Return, if drag&drop object can be decode to iCalendar.
 */
-[[nodiscard]] KCALUTILS_EXPORT bool canDecode(const QMimeData *);
+[[nodiscard]] KCALUTILSCORE_EXPORT bool canDecode(const QMimeData *);
 
 /**
   Decode drag&drop object to iCalendar component \a cal.
 */
-[[nodiscard]] KCALUTILS_EXPORT bool fromMimeData(const QMimeData *e, const KCalendarCore::Calendar::Ptr &cal);
+[[nodiscard]] KCALUTILSCORE_EXPORT bool fromMimeData(const QMimeData *e, const KCalendarCore::Calendar::Ptr &cal);
 }
 }
@@ -21,8 +21,14 @@
   @author Allen Winter \<allen@kdab.com\>
 */
 #include "incidenceformatter.h"
+#include "busyperiods_p.h"
+#include "formatterproviders_p.h"
+#include "formatterstatistics_p.h"
 #include "grantleetemplatemanager_p.h"
+#include "htmltext_p.h"
+#include "invitationdiff_p.h"
 #include "stringify.h"
+#include "tracing_p.h"
 
 #include <KCalendarCore/Event>
 #include <KCalendarCore/FreeBusy>
@@ -38,15 +44,19 @@ using namespace KCalendarCore;
 #include <ktexttohtml.h>
 
 #include "kcalutils_debug.h"
-#include <KIconLoader>
 #include <KLocalizedString>
 
-#include <QApplication>
 #include <QBitArray>
+#include <QCoreApplication>
 #include <QLocale>
 #include <QMimeDatabase>
-#include <QPalette>
+#include <QMutex>
+#include <QPromise>
 #include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+
+#include <memory>
 
 using namespace KCalUtils;
 using namespace IncidenceFormatter;
@@ -75,27 +85,9 @@ static bool iamAttendee(const Attendee &attendee)
     return thatIsMe(attendee.email());
 }
 
-static QString htmlAddTag(const QString &tag, const QString &text)
-{
-    int numLineBreaks = text.count(QLatin1Char('\n'));
-    const QString str = QLatin1Char('<') + tag + QLatin1Char('>');
-    QString tmpText = text;
-    QString tmpStr = str;
-    if (numLineBreaks >= 0) {
-        if (numLineBreaks > 0) {
-            QString tmp;
-            for (int i = 0; i <= numLineBreaks; ++i) {
-                int pos = tmpText.indexOf(QLatin1Char('\n'));
-                tmp = tmpText.left(pos);
-                tmpText = tmpText.right(tmpText.length() - pos - 1);
-                tmpStr += tmp + QLatin1String("<br>");
-            }
-        } else {
-            tmpStr += tmpText;
-        }
-    }
-    tmpStr += QLatin1String("</") + tag + QLatin1Char('>');
-    return tmpStr;
+static QString htmlAddTag(QLatin1StringView tag, const QString &text)
+{
+    return HtmlText::linesToHtml(text, tag, HtmlText::TrailingBreak);
 }
 
 static QPair<QString, QString> searchNameAndUid(const QString &email, const QString &name, const QString &uid)
@@ -338,31 +330,66 @@ static QVariantHash displayViewFormatOrganizer(const Incidence::Ptr &incidence)
     return QVariantHash();
 }
 
+// The parts of an attachment needed to display it. The formatter never shows
+// the payload of inline attachments, so it stays away from the accessors
+// that decode it.
+struct AttachmentMetadata {
+    QString label;
+    QString mimeType;
+    QString uri; // empty for inline attachments
+    bool isUri = false;
+};
+
+static QList<AttachmentMetadata> attachmentMetadata(const Incidence::Ptr &incidence)
+{
+    QList<AttachmentMetadata> metadata;
+    const Attachment::List attachments = incidence->attachments();
+    metadata.reserve(attachments.count());
+    for (const Attachment &a : attachments) {
+        // Do not use Attachment::size(), data() or decodedData() here,
+        // they decode the payload of inline attachments.
+        AttachmentMetadata m;
+        m.label = a.label();
+        m.mimeType = a.mimeType();
+        m.isUri = a.isUri();
+        if (m.isUri) {
+            m.uri = a.uri();
+        }
+        metadata.push_back(m);
+    }
+    return metadata;
+}
+
+static QString attachmentLabelUri(const QString &label)
+{
+    return QStringLiteral("ATTACH:%1").arg(QString::fromLatin1(label.toUtf8().toBase64()));
+}
+
 static QVariantList displayViewFormatAttachments(const Incidence::Ptr &incidence)
 {
-    const Attachment::List as = incidence->attachments();
+    const QList<AttachmentMetadata> as = attachmentMetadata(incidence);
 
     QVariantList dataList;
     dataList.reserve(as.count());
 
-    for (auto it = as.cbegin(), end = as.cend(); it != end; ++it) {
+    for (const AttachmentMetadata &a : as) {
         QVariantHash attData;
-        if ((*it).isUri()) {
+        if (a.isUri) {
             QString name;
-            if ((*it).uri().startsWith(QLatin1String("kmail:"))) {
+            if (a.uri.startsWith(QLatin1String("kmail:"))) {
                 name = i18n("Show mail");
             } else {
-                if ((*it).label().isEmpty()) {
-                    name = (*it).uri();
+                if (a.label.isEmpty()) {
+                    name = a.uri;
                 } else {
-                    name = (*it).label();
+                    name = a.label;
                 }
             }
-            attData[QStringLiteral("uri")] = (*it).uri();
+            attData[QStringLiteral("uri")] = a.uri;
             attData[QStringLiteral("label")] = name;
         } else {
-            attData[QStringLiteral("uri")] = QStringLiteral("ATTACH:%1").arg(QString::fromUtf8((*it).label().toUtf8().toBase64()));
-            attData[QStringLiteral("label")] = (*it).label();
+            attData[QStringLiteral("uri")] = attachmentLabelUri(a.label);
+            attData[QStringLiteral("label")] = a.label;
         }
         dataList << attData;
     }
@@ -572,6 +599,60 @@ static QString displayViewFormatJournal(const Calendar::Ptr &calendar, const QSt
     return GrantleeTemplateManager::instance()->render(QStringLiteral(":/journal.html"), incidence);
 }
 
+// Free/busy objects with more busy periods than this are shown as
+// a per-day timeline instead of a list of periods
+static const int compactFreeBusyThreshold = 50;
+
+static QString periodDurationString(const Period &period)
+{
+    int dur = period.duration().asSeconds();
+    QString cont;
+    if (dur >= 3600) {
+        cont += i18ncp("hours part of duration", "1 hour ", "%1 hours ", dur / 3600);
+        dur %= 3600;
+    }
+    if (dur >= 60) {
+        // Same message as before the two copies were merged; it keeps its translations
+        cont += i18ncp("minutes part duration", "1 minute ", "%1 minutes ", dur / 60);
+        dur %= 60;
+    }
+    if (dur > 0) {
+        cont += i18ncp("seconds part of duration", "1 second", "%1 seconds", dur);
+    }
+    return cont.trimmed();
+}
+
+static QVariantList freeBusyTimeline(const FreeBusy::Ptr &fb, const Period::List &periods)
+{
+    const auto slotTime = [](int slot) {
+        return slot == BusyPeriods::slotsPerDay ? QTime(23, 59, 59) : QTime(0, 0).addSecs(slot * BusyPeriods::slotMinutes * 60);
+    };
+    const auto percent = [](int slots) {
+        return QString::number(slots * 100.0 / BusyPeriods::slotsPerDay, 'f', 2);
+    };
+
+    QVariantList days;
+    const QList<BusyPeriods::DayTimeline> timeline = BusyPeriods::timeline(periods, fb->dtStart(), fb->dtEnd());
+    days.reserve(timeline.count());
+    for (const BusyPeriods::DayTimeline &day : timeline) {
+        QVariantList segments;
+        segments.reserve(day.ranges.count());
+        for (const auto &range : day.ranges) {
+            QVariantHash segment;
+            segment[QStringLiteral("left")] = percent(range.first);
+            segment[QStringLiteral("width")] = percent(range.second - range.first);
+            segment[QStringLiteral("start")] = slotTime(range.first);
+            segment[QStringLiteral("end")] = slotTime(range.second);
+            segments.push_back(segment);
+        }
+        QVariantHash dayData;
+        dayData[QStringLiteral("date")] = day.date;
+        dayData[QStringLiteral("segments")] = segments;
+        days.push_back(dayData);
+    }
+    return days;
+}
+
 static QString displayViewFormatFreeBusy(const Calendar::Ptr &calendar, const QString &sourceName, const FreeBusy::Ptr &fb)
 {
     Q_UNUSED(calendar)
@@ -585,28 +666,19 @@ static QString displayViewFormatFreeBusy(const Calendar::Ptr &calendar, const QS
     fbData[QStringLiteral("start")] = fb->dtStart().toLocalTime().date();
     fbData[QStringLiteral("end")] = fb->dtEnd().toLocalTime().date();
 
-    Period::List periods = fb->busyPeriods();
+    const Period::List periods = BusyPeriods::coalesce(fb->busyPeriods());
+    if (periods.count() > compactFreeBusyThreshold) {
+        fbData[QStringLiteral("timeline")] = freeBusyTimeline(fb, periods);
+        return GrantleeTemplateManager::instance()->render(QStringLiteral(":/freebusy.html"), fbData);
+    }
+
     QVariantList periodsData;
     periodsData.reserve(periods.size());
-    for (auto it = periods.cbegin(), end = periods.cend(); it != end; ++it) {
-        const Period per = *it;
+    for (const Period &per : periods) {
         QVariantHash periodData;
         if (per.hasDuration()) {
-            int dur = per.duration().asSeconds();
-            QString cont;
-            if (dur >= 3600) {
-                cont += i18ncp("hours part of duration", "1 hour ", "%1 hours ", dur / 3600);
-                dur %= 3600;
-            }
-            if (dur >= 60) {
-                cont += i18ncp("minutes part duration", "1 minute ", "%1 minutes ", dur / 60);
-                dur %= 60;
-            }
-            if (dur > 0) {
-                cont += i18ncp("seconds part of duration", "1 second", "%1 seconds", dur);
-            }
             periodData[QStringLiteral("dtStart")] = per.start().toLocalTime();
-            periodData[QStringLiteral("duration")] = cont;
+            periodData[QStringLiteral("duration")] = periodDurationString(per);
         } else {
             const QDateTime pStart = per.start().toLocalTime();
             const QDateTime pEnd = per.end().toLocalTime();
@@ -666,24 +738,28 @@ public:
 protected:
     bool visit(const Event::Ptr &event) override
     {
+        Tracing::TraceSpan span("displayViewFormatEvent");
         mResult = displayViewFormatEvent(mCalendar, mSourceName, event, mDate);
         return !mResult.isEmpty();
     }
 
     bool visit(const Todo::Ptr &todo) override
     {
+        Tracing::TraceSpan span("displayViewFormatTodo");
         mResult = displayViewFormatTodo(mCalendar, mSourceName, todo, mDate);
         return !mResult.isEmpty();
     }
 
     bool visit(const Journal::Ptr &journal) override
     {
+        Tracing::TraceSpan span("displayViewFormatJournal");
         mResult = displayViewFormatJournal(mCalendar, mSourceName, journal);
         return !mResult.isEmpty();
     }
 
     bool visit(const FreeBusy::Ptr &fb) override
     {
+        Tracing::TraceSpan span("displayViewFormatFreeBusy");
         mResult = displayViewFormatFreeBusy(mCalendar, mSourceName, fb);
         return !mResult.isEmpty();
     }
@@ -706,9 +782,10 @@ QString IncidenceFormatter::extensiveDisplayStr(const Calendar::Ptr &calendar, c
         return QString();
     }
 
+    FormatterStatistics::CallScope scope(Statistics::ExtensiveDisplay);
     EventViewerVisitor v;
     if (v.act(calendar, incidence, date)) {
-        return v.result();
+        return scope.result(v.result());
     } else {
         return QString();
     }
@@ -720,9 +797,10 @@ QString IncidenceFormatter::extensiveDisplayStr(const QString &sourceName, const
         return QString();
     }
 
+    FormatterStatistics::CallScope scope(Statistics::ExtensiveDisplay);
     EventViewerVisitor v;
     if (v.act(sourceName, incidence, date)) {
-        return v.result();
+        return scope.result(v.result());
     } else {
         return QString();
     }
@@ -735,11 +813,12 @@ QString IncidenceFormatter::extensiveDisplayStr(const QString &sourceName, const
 //@cond PRIVATE
 static QString cleanHtml(const QString &html)
 {
-    static QRegularExpression rx = QRegularExpression(QStringLiteral("<body[^>]*>(.*)</body>"), QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch match = rx.match(html);
+    static const QRegularExpression rx(QStringLiteral("<body[^>]*>(.*)</body>"), QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression tagRx(QStringLiteral("<[^>]*>"));
+    const QRegularExpressionMatch match = rx.match(html);
     if (match.hasMatch()) {
         QString body = match.captured(1);
-        return body.remove(QRegularExpression(QStringLiteral("<[^>]*>"))).trimmed().toHtmlEscaped();
+        return body.remove(tagRx).trimmed().toHtmlEscaped();
     }
     return html;
 }
@@ -779,15 +858,13 @@ static QString invitationLocation(const Incidence::Ptr &incidence, bool noHtmlMo
 static QString diffColor()
 {
     // Color for printing comparison differences inside invitations.
-
-    //  return  "#DE8519"; // hard-coded color from Outlook2007
-    return QColor(Qt::red).name(); // krazy:exclude=qenums TODO make configurable
+    return IncidenceFormatter::colorProvider()->color(IncidenceFormatter::ColorProvider::DiffColor);
 }
 
 static QString noteColor()
 {
     // Color for printing notes inside invitations.
-    return qApp->palette().color(QPalette::Active, QPalette::Highlight).name();
+    return IncidenceFormatter::colorProvider()->color(IncidenceFormatter::ColorProvider::NoteColor);
 }
 
 static QString htmlCompare(const QString &value, const QString &oldvalue)
@@ -806,6 +883,55 @@ static QString htmlCompare(const QString &value, const QString &oldvalue)
     return QStringLiteral("<font color=\"%1\">%2</font> (<strike>%3</strike>)").arg(diffColor(), value, oldvalue);
 }
 
+template<typename T, typename Formatter>
+static QString htmlCompareField(const InvitationDiff &diff, InvitationDiff::Fields fields, const T &incidence, const T &oldincidence, Formatter format)
+{
+    // Unchanged fields are formatted only once
+    const QString value = format(incidence);
+    if (!diff.isChanged(fields)) {
+        return value;
+    }
+    return htmlCompare(value, format(oldincidence));
+}
+
+static QStringList invitationChanges(const InvitationDiff &diff)
+{
+    // Changes that are not visible in the compared fields of the invitation
+    QStringList changes;
+    const auto attendeeChanges = diff.attendeeChanges();
+    for (const InvitationDiff::AttendeeChange &change : attendeeChanges) {
+        const QString name = change.attendee.fullName().toHtmlEscaped();
+        switch (change.type) {
+        case InvitationDiff::AttendeeChange::Added:
+            changes << i18nc("@info attendee name", "%1 was added", name);
+            break;
+        case InvitationDiff::AttendeeChange::Removed:
+            changes << i18nc("@info attendee name", "%1 was removed", name);
+            break;
+        case InvitationDiff::AttendeeChange::StatusChanged:
+            changes << i18nc("@info attendee name, old status, new status",
+                             "%1 changed from %2 to %3",
+                             name,
+                             Stringify::attendeeStatus(change.oldStatus),
+                             Stringify::attendeeStatus(change.attendee.status()));
+            break;
+        }
+    }
+    if (diff.isChanged(InvitationDiff::Description)) {
+        changes << i18n("The description was changed");
+    }
+    if (diff.isChanged(InvitationDiff::Alarms)) {
+        changes << i18n("The reminders were changed");
+    }
+    if (diff.isChanged(InvitationDiff::Categories)) {
+        changes << i18n("The tags were changed");
+    }
+    if (diff.isChanged(InvitationDiff::Priority)) {
+        changes << i18n("The priority was changed");
+    }
+    return changes;
+}
+
 static Attendee findDelegatedFromMyAttendee(const Incidence::Ptr &incidence)
 {
     // Return the first attendee that was delegated-from the user
@@ -949,7 +1075,7 @@ static QString invitationDescriptionIncidence(const Incidence::Ptr &incidence, b
             if (noHtmlMode) {
                 descr = cleanHtml(descr);
             }
-            return htmlAddTag(QStringLiteral("p"), descr);
+            return htmlAddTag(QLatin1StringView("p"), descr);
         }
     }
 
@@ -996,6 +1122,8 @@ static QVariantList eventsOnSameDays(InvitationFormatterHelper *helper, const Ev
         return QVariantList();
     }
 
+    Tracing::TraceSpan span("eventsOnSameDays");
+    FormatterStatistics::PhaseTimer timer(Statistics::LookupPhase);
     QDateTime startDay = event->dtStart();
     QDateTime endDay = event->hasEndDate() ? event->dtEnd() : event->dtStart();
     startDay.setTime(QTime(0, 0, 0));
@@ -1102,16 +1230,30 @@ static QVariantHash invitationDetailsEvent(InvitationFormatterHelper *helper,
         incidence[QStringLiteral("note")] = invitationNote(QString(), i18n("Please respond again to the original proposal."), noteColor());
     }
 
+    const InvitationDiff diff(event, oldevent);
+    const InvitationDiff::Fields timeFields = InvitationDiff::DtStart | InvitationDiff::DtEnd | InvitationDiff::AllDay;
+
     incidence[QStringLiteral("isDiff")] = true;
     incidence[QStringLiteral("iconName")] = QStringLiteral("view-pim-calendar");
-    incidence[QStringLiteral("summary")] = htmlCompare(invitationSummary(event, noHtmlMode), invitationSummary(oldevent, noHtmlMode));
-    incidence[QStringLiteral("location")] = htmlCompare(invitationLocation(event, noHtmlMode), invitationLocation(oldevent, noHtmlMode));
+    incidence[QStringLiteral("summary")] = htmlCompareField(diff, InvitationDiff::Summary, event, oldevent, [noHtmlMode](const Event::Ptr &e) {
+        return invitationSummary(e, noHtmlMode);
+    });
+    incidence[QStringLiteral("location")] = htmlCompareField(diff, InvitationDiff::Location, event, oldevent, [noHtmlMode](const Event::Ptr &e) {
+        return invitationLocation(e, noHtmlMode);
+    });
     incidence[QStringLiteral("recurs")] = event->recurs() || oldevent->recurs();
-    incidence[QStringLiteral("recurrence")] = htmlCompare(recurrenceString(event), recurrenceString(oldevent));
-    incidence[QStringLiteral("dateTime")] = htmlCompare(IncidenceFormatter::formatStartEnd(event->dtStart(), event->dtEnd(), event->allDay()),
-                                                        IncidenceFormatter::formatStartEnd(oldevent->dtStart(), oldevent->dtEnd(), oldevent->allDay()));
-    incidence[QStringLiteral("duration")] = htmlCompare(durationString(event), durationString(oldevent));
+    incidence[QStringLiteral("recurrence")] =
+        htmlCompareField(diff, InvitationDiff::Recurrence | InvitationDiff::DtStart, event, oldevent, [](const Event::Ptr &e) {
+            return recurrenceString(e);
+        });
+    incidence[QStringLiteral("dateTime")] = htmlCompareField(diff, timeFields, event, oldevent, [](const Event::Ptr &e) {
+        return IncidenceFormatter::formatStartEnd(e->dtStart(), e->dtEnd(), e->allDay());
+    });
+    incidence[QStringLiteral("duration")] = htmlCompareField(diff, timeFields, event, oldevent, [](const Event::Ptr &e) {
+        return durationString(e);
+    });
     incidence[QStringLiteral("description")] = invitationDescriptionIncidence(event, noHtmlMode);
+    incidence[QStringLiteral("changes")] = invitationChanges(diff);
 
     incidence[QStringLiteral("checkCalendarButton")] =
         inviteButton(QStringLiteral("check_calendar"), i18n("Check my calendar"), QStringLiteral("go-jump-today"), helper);
@@ -1172,20 +1314,39 @@ static QVariantHash invitationDetailsTodo(const Todo::Ptr &todo, const Todo::Ptr
         incidence[QStringLiteral("note")] = invitationNote(QString(), i18n("Please respond again to the original proposal."), noteColor());
     }
 
+    const InvitationDiff diff(todo, oldtodo);
+
     incidence[QStringLiteral("iconName")] = QStringLiteral("view-pim-tasks");
     incidence[QStringLiteral("isDiff")] = true;
-    incidence[QStringLiteral("summary")] = htmlCompare(invitationSummary(todo, noHtmlMode), invitationSummary(oldtodo, noHtmlMode));
-    incidence[QStringLiteral("location")] = htmlCompare(invitationLocation(todo, noHtmlMode), invitationLocation(oldtodo, noHtmlMode));
+    incidence[QStringLiteral("summary")] = htmlCompareField(diff, InvitationDiff::Summary, todo, oldtodo, [noHtmlMode](const Todo::Ptr &t) {
+        return invitationSummary(t, noHtmlMode);
+    });
+    incidence[QStringLiteral("location")] = htmlCompareField(diff, InvitationDiff::Location, todo, oldtodo, [noHtmlMode](const Todo::Ptr &t) {
+        return invitationLocation(t, noHtmlMode);
+    });
     incidence[QStringLiteral("isAllDay")] = todo->allDay();
     incidence[QStringLiteral("hasStartDate")] = todo->hasStartDate();
-    incidence[QStringLiteral("dtStartStr")] = htmlCompare(dateTimeToString(todo->dtStart(), false, false), dateTimeToString(oldtodo->dtStart(), false, false));
-    incidence[QStringLiteral("dtDueStr")] = htmlCompare(dateTimeToString(todo->dtDue(), false, false), dateTimeToString(oldtodo->dtDue(), false, false));
-    incidence[QStringLiteral("duration")] = htmlCompare(durationString(todo), durationString(oldtodo));
-    incidence[QStringLiteral("percentComplete")] = htmlCompare(i18n("%1%", todo->percentComplete()), i18n("%1%", oldtodo->percentComplete()));
+    incidence[QStringLiteral("dtStartStr")] = htmlCompareField(diff, InvitationDiff::DtStart, todo, oldtodo, [](const Todo::Ptr &t) {
+        return dateTimeToString(t->dtStart(), false, false);
+    });
+    incidence[QStringLiteral("dtDueStr")] = htmlCompareField(diff, InvitationDiff::DtEnd, todo, oldtodo, [](const Todo::Ptr &t) {
+        return dateTimeToString(t->dtDue(), false, false);
+    });
+    incidence[QStringLiteral("duration")] =
+        htmlCompareField(diff, InvitationDiff::DtStart | InvitationDiff::DtEnd | InvitationDiff::AllDay, todo, oldtodo, [](const Todo::Ptr &t) {
+            return durationString(t);
+        });
+    incidence[QStringLiteral("percentComplete")] = htmlCompareField(diff, InvitationDiff::PercentComplete, todo, oldtodo, [](const Todo::Ptr &t) {
+        return i18n("%1%", t->percentComplete());
+    });
 
     incidence[QStringLiteral("recurs")] = todo->recurs() || oldtodo->recurs();
-    incidence[QStringLiteral("recurrence")] = htmlCompare(recurrenceString(todo), recurrenceString(oldtodo));
+    incidence[QStringLiteral("recurrence")] =
+        htmlCompareField(diff, InvitationDiff::Recurrence | InvitationDiff::DtStart, todo, oldtodo, [](const Todo::Ptr &t) {
+            return recurrenceString(t);
+        });
     incidence[QStringLiteral("description")] = invitationDescriptionIncidence(todo, noHtmlMode);
+    incidence[QStringLiteral("changes")] = invitationChanges(diff);
 
     return incidence;
 }
@@ -1211,12 +1372,18 @@ static QVariantHash invitationDetailsJournal(const Journal::Ptr &journal, const
         return invitationDetailsJournal(journal, noHtmlMode);
     }
 
+    const InvitationDiff diff(journal, oldjournal);
+
     QVariantHash incidence;
     incidence[QStringLiteral("iconName")] = QStringLiteral("view-pim-journal");
-    incidence[QStringLiteral("summary")] = htmlCompare(invitationSummary(journal, noHtmlMode), invitationSummary(oldjournal, noHtmlMode));
-    incidence[QStringLiteral("dateStr")] =
-        htmlCompare(dateToString(journal->dtStart().toLocalTime().date(), false), dateToString(oldjournal->dtStart().toLocalTime().date(), false));
+    incidence[QStringLiteral("summary")] = htmlCompareField(diff, InvitationDiff::Summary, journal, oldjournal, [noHtmlMode](const Journal::Ptr &j) {
+        return invitationSummary(j, noHtmlMode);
+    });
+    incidence[QStringLiteral("dateStr")] = htmlCompareField(diff, InvitationDiff::DtStart, journal, oldjournal, [](const Journal::Ptr &j) {
+        return dateToString(j->dtStart().toLocalTime().date(), false);
+    });
     incidence[QStringLiteral("description")] = invitationDescriptionIncidence(journal, noHtmlMode);
+    incidence[QStringLiteral("changes")] = invitationChanges(diff);
 
     return incidence;
 }
@@ -1234,29 +1401,22 @@ static QVariantHash invitationDetailsFreeBusy(const FreeBusy::Ptr &fb, bool noHt
     incidence[QStringLiteral("dtStart")] = fb->dtStart();
     incidence[QStringLiteral("dtEnd")] = fb->dtEnd();
 
+    const Period::List periods = BusyPeriods::coalesce(fb->busyPeriods());
+    if (periods.count() > compactFreeBusyThreshold) {
+        incidence[QStringLiteral("timeline")] = freeBusyTimeline(fb, periods);
+        return incidence;
+    }
+
     QVariantList periodsList;
-    const Period::List periods = fb->busyPeriods();
-    for (auto it = periods.cbegin(), end = periods.cend(); it != end; ++it) {
+    periodsList.reserve(periods.count());
+    for (const Period &per : periods) {
         QVariantHash period;
-        period[QStringLiteral("hasDuration")] = it->hasDuration();
-        if (it->hasDuration()) {
-            int dur = it->duration().asSeconds();
-            QString cont;
-            if (dur >= 3600) {
-                cont += i18ncp("hours part of duration", "1 hour ", "%1 hours ", dur / 3600);
-                dur %= 3600;
-            }
-            if (dur >= 60) {
-                cont += i18ncp("minutes part of duration", "1 minute", "%1 minutes ", dur / 60);
-                dur %= 60;
-            }
-            if (dur > 0) {
-                cont += i18ncp("seconds part of duration", "1 second", "%1 seconds", dur);
-            }
-            period[QStringLiteral("duration")] = cont;
+        period[QStringLiteral("hasDuration")] = per.hasDuration();
+        if (per.hasDuration()) {
+            period[QStringLiteral("duration")] = periodDurationString(per);
         }
-        period[QStringLiteral("start")] = it->start();
-        period[QStringLiteral("end")] = it->end();
+        period[QStringLiteral("start")] = per.start();
+        period[QStringLiteral("end")] = per.end();
 
         periodsList.push_back(period);
     }
@@ -1726,6 +1886,30 @@ static QVariantList invitationRsvpList(const Incidence::Ptr &incidence, const At
     return attendees;
 }
 
+static QString mimeTypeIconName(const QString &mimeTypeName)
+{
+    static const QMimeDatabase mimeDb;
+    const QMimeType mimeType = mimeDb.mimeTypeForName(mimeTypeName);
+    if (!mimeType.isValid()) {
+        return QStringLiteral("application-octet-stream");
+    }
+
+    // Invitations often carry many attachments of the same few types, so
+    // remember the icon of every mime type looked up so far. The key is the
+    // canonical name from the database rather than the attachment's own
+    // string, which bounds the cache by the number of known mime types.
+    static QMutex mutex;
+    static QHash<QString, QString> iconNames;
+
+    QMutexLocker locker(&mutex);
+    auto it = iconNames.constFind(mimeType.name());
+    if (it == iconNames.constEnd()) {
+        it = iconNames.insert(mimeType.name(), mimeType.iconName());
+        FormatterStatistics::addCacheMemory((it.key().size() + it.value().size()) * qint64(sizeof(QChar)));
+    }
+    return it.value();
+}
+
 static QVariantList invitationAttachments(const Incidence::Ptr &incidence, InvitationFormatterHelper *helper)
 {
     if (!incidence) {
@@ -1738,14 +1922,13 @@ static QVariantList invitationAttachments(const Incidence::Ptr &incidence, Invit
     }
 
     QVariantList attachments;
-    const Attachment::List lstAttachments = incidence->attachments();
-    for (const Attachment &a : lstAttachments) {
+    const QList<AttachmentMetadata> lstAttachments = attachmentMetadata(incidence);
+    attachments.reserve(lstAttachments.count());
+    for (const AttachmentMetadata &a : lstAttachments) {
         QVariantHash attachment;
-        QMimeDatabase mimeDb;
-        auto mimeType = mimeDb.mimeTypeForName(a.mimeType());
-        attachment[QStringLiteral("icon")] = (mimeType.isValid() ? mimeType.iconName() : QStringLiteral("application-octet-stream"));
-        attachment[QStringLiteral("name")] = a.label();
-        const QString attachementStr = helper->generateLinkURL(QStringLiteral("ATTACH:%1").arg(QString::fromLatin1(a.label().toUtf8().toBase64())));
+        attachment[QStringLiteral("icon")] = mimeTypeIconName(a.mimeType);
+        attachment[QStringLiteral("name")] = a.label;
+        const QString attachementStr = helper->generateLinkURL(attachmentLabelUri(a.label));
         attachment[QStringLiteral("uri")] = attachementStr;
         attachments.push_back(attachment);
     }
@@ -2013,12 +2196,11 @@ static QVariantList cancelButtons(const Incidence::Ptr &incidence, InvitationFor
 
 static QVariantHash invitationStyle()
 {
+    const IncidenceFormatter::ColorProvider *colors = IncidenceFormatter::colorProvider();
     QVariantHash style;
-    QPalette p;
-    p.setCurrentColorGroup(QPalette::Normal);
-    style[QStringLiteral("buttonBg")] = p.color(QPalette::Button).name();
-    style[QStringLiteral("buttonBorder")] = p.shadow().color().name();
-    style[QStringLiteral("buttonFg")] = p.color(QPalette::ButtonText).name();
+    style[QStringLiteral("buttonBg")] = colors->color(IncidenceFormatter::ColorProvider::ButtonBackgroundColor);
+    style[QStringLiteral("buttonBorder")] = colors->color(IncidenceFormatter::ColorProvider::ButtonBorderColor);
+    style[QStringLiteral("buttonFg")] = colors->color(IncidenceFormatter::ColorProvider::ButtonTextColor);
     return style;
 }
 
@@ -2034,10 +2216,17 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
         return QString();
     }
 
+    Tracing::TraceSpan span("formatICalInvitation");
+
+    Tracing::TraceSpan parseSpan("parseScheduleMessage");
+    FormatterStatistics::PhaseTimer parseTimer(Statistics::ParsePhase);
     ICalFormat format;
     // parseScheduleMessage takes the tz from the calendar,
     // no need to set it manually here for the format!
     ScheduleMessage::Ptr msg = format.parseScheduleMessage(mCalendar, invitation);
+    FormatterStatistics::countInvitationParse();
+    parseTimer.end();
+    parseSpan.end();
 
     if (!msg) {
         qCDebug(KCALUTILS_LOG) << "Failed to parse the scheduling message";
@@ -2048,9 +2237,13 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
 
     IncidenceBase::Ptr incBase = msg->event();
 
+    Tracing::TraceSpan shiftSpan("shiftTimes");
     incBase->shiftTimes(mCalendar->timeZone(), QTimeZone::systemTimeZone());
+    shiftSpan.end();
 
     // Determine if this incidence is in my calendar (and owned by me)
+    Tracing::TraceSpan lookupSpan("findExistingIncidence");
+    FormatterStatistics::PhaseTimer lookupTimer(Statistics::LookupPhase);
     Incidence::Ptr existingIncidence;
     if (incBase && helper->calendar()) {
         existingIncidence = helper->calendar()->incidence(incBase->uid(), incBase->recurrenceId());
@@ -2070,6 +2263,9 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
         }
     }
 
+    lookupTimer.end();
+    lookupSpan.end();
+
     Incidence::Ptr inc = incBase.staticCast<Incidence>(); // the incidence in the invitation email
 
     // If the IncidenceBase is a FreeBusy, then we cannot access the revision number in
@@ -2079,15 +2275,18 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
         incRevision = inc->revision();
     }
 
+    Tracing::TraceSpan headerSpan("invitationHeader");
     IncidenceFormatter::InvitationHeaderVisitor headerVisitor;
     // The InvitationHeaderVisitor returns false if the incidence is somehow invalid, or not handled
     if (!headerVisitor.act(inc, existingIncidence, msg, sender)) {
         return QString();
     }
+    headerSpan.end();
 
     QVariantHash incidence;
 
     // use the Outlook 2007 Comparison Style
+    Tracing::TraceSpan bodySpan("invitationBody");
     IncidenceFormatter::InvitationBodyVisitor bodyVisitor(helper, noHtmlMode);
     bool bodyOk;
     if (msg->method() == iTIPRequest || msg->method() == iTIPReply || msg->method() == iTIPDeclineCounter) {
@@ -2102,7 +2301,9 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
     if (!bodyOk) {
         return QString();
     }
+    bodySpan.end();
 
+    Tracing::TraceSpan contextSpan("buildContext");
     incidence = bodyVisitor.result();
     incidence[QStringLiteral("style")] = invitationStyle();
     incidence[QStringLiteral("head")] = headerVisitor.result();
@@ -2299,6 +2500,7 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
     case KCalendarCore::IncidenceBase::TypeUnknown:
         return QString();
     }
+    contextSpan.end();
 
     return GrantleeTemplateManager::instance()->render(templateName, incidence);
 }
@@ -2307,7 +2509,8 @@ formatICalInvitationHelper(const QString &invitation, const Calendar::Ptr &mCale
 
 QString IncidenceFormatter::formatICalInvitation(const QString &invitation, const Calendar::Ptr &calendar, InvitationFormatterHelper *helper)
 {
-    return formatICalInvitationHelper(invitation, calendar, helper, false, QString());
+    FormatterStatistics::CallScope scope(Statistics::Invitation);
+    return scope.result(formatICalInvitationHelper(invitation, calendar, helper, false, QString()));
 }
 
 QString IncidenceFormatter::formatICalInvitationNoHtml(const QString &invitation,
@@ -2315,7 +2518,8 @@ QString IncidenceFormatter::formatICalInvitationNoHtml(const QString &invitation
                                                        InvitationFormatterHelper *helper,
                                                        const QString &sender)
 {
-    return formatICalInvitationHelper(invitation, calendar, helper, true, sender);
+    FormatterStatistics::CallScope scope(Statistics::InvitationNoHtml);
+    return scope.result(formatICalInvitationHelper(invitation, calendar, helper, true, sender));
 }
 
 /*******************************************************************
@@ -2507,18 +2711,35 @@ bool IncidenceFormatter::ToolTipVisitor::visit(const FreeBusy::Ptr &fb)
     return !mResult.isEmpty();
 }
 
+static QString tooltipIconUrl(const QString &iconPath)
+{
+    return iconMode() == IconDataUris ? FormatterProviders::iconDataUri(iconPath) : iconPath;
+}
+
+// Paths of the tooltip icons, also looked up by warmUp()
+static QString tooltipStatusIconPath(Attendee::PartStat status)
+{
+    return IncidenceFormatter::iconProvider()->iconPath(rsvpStatusIconName(status), FormatterProviders::smallIconGroup, false);
+}
+
+static QString tooltipOrganizerIconPath()
+{
+    // TODO fixme laurent: use another icon. It doesn't exist in breeze.
+    return IncidenceFormatter::iconProvider()->iconPath(QStringLiteral("meeting-organizer"), FormatterProviders::smallIconGroup, true);
+}
+
 static QString tooltipPerson(const QString &email, const QString &name, Attendee::PartStat status)
 {
     // Search for a new print name, if needed.
     const QString printName = searchName(email, name);
 
     // Get the icon corresponding to the attendee participation status.
-    const QString iconPath = KIconLoader::global()->iconPath(rsvpStatusIconName(status), KIconLoader::Small);
+    const QString iconPath = tooltipStatusIconPath(status);
 
     // Make the return string.
     QString personString;
     if (!iconPath.isEmpty()) {
-        personString += QLatin1String(R"(<img valign="top" src=")") + iconPath + QLatin1String("\">") + QLatin1String("&nbsp;");
+        personString += QLatin1String(R"(<img valign="top" src=")") + tooltipIconUrl(iconPath) + QLatin1String("\">") + QLatin1String("&nbsp;");
     }
     if (status != Attendee::None) {
         personString += i18nc("attendee name (attendee status)", "%1 (%2)", printName.isEmpty() ? email : printName, Stringify::attendeeStatus(status));
@@ -2534,13 +2755,12 @@ static QString tooltipFormatOrganizer(const QString &email, const QString &name)
     const QString printName = searchName(email, name);
 
     // Get the icon for organizer
-    // TODO fixme laurent: use another icon. It doesn't exist in breeze.
-    const QString iconPath = KIconLoader::global()->iconPath(QStringLiteral("meeting-organizer"), KIconLoader::Small, true);
+    const QString iconPath = tooltipOrganizerIconPath();
 
     // Make the return string.
     QString personString;
     if (!iconPath.isEmpty()) {
-        personString += QLatin1String(R"(<img valign="top" src=")") + iconPath + QLatin1String("\">") + QLatin1String("&nbsp;");
+        personString += QLatin1String(R"(<img valign="top" src=")") + tooltipIconUrl(iconPath) + QLatin1String("\">") + QLatin1String("&nbsp;");
     }
     personString += (printName.isEmpty() ? email : printName);
     return personString;
@@ -2686,7 +2906,7 @@ QString IncidenceFormatter::ToolTipVisitor::generateToolTip(const Incidence::Ptr
             if (desc.length() > maxDescLen) {
                 desc = desc.left(maxDescLen) + i18nc("ellipsis", "...");
             }
-            desc = desc.toHtmlEscaped().replace(QLatin1Char('\n'), QLatin1String("<br>"));
+            desc = HtmlText::linesToHtml(desc, {}, HtmlText::Escape);
         } else {
             // TODO: truncate the description when it's rich text
         }
@@ -2735,9 +2955,10 @@ QString IncidenceFormatter::ToolTipVisitor::generateToolTip(const Incidence::Ptr
 
 QString IncidenceFormatter::toolTipStr(const QString &sourceName, const IncidenceBase::Ptr &incidence, QDate date, bool richText)
 {
+    FormatterStatistics::CallScope scope(Statistics::ToolTip);
     ToolTipVisitor v;
     if (incidence && v.act(sourceName, incidence, date, richText)) {
-        return v.result();
+        return scope.result(v.result());
     } else {
         return QString();
     }
@@ -2901,9 +3122,10 @@ QString IncidenceFormatter::mailBodyStr(const IncidenceBase::Ptr &incidence)
         return QString();
     }
 
+    FormatterStatistics::CallScope scope(Statistics::MailBody);
     MailBodyVisitor v;
     if (v.act(incidence)) {
-        return v.result();
+        return scope.result(v.result());
     }
     return QString();
 }
@@ -2926,6 +3148,142 @@ static QString recurEnd(const Incidence::Ptr &incidence)
  *  More static formatting functions
  ************************************/
 
+//@cond PRIVATE
+// Translated on every call rather than cached, so that the strings follow
+// the current language and can be used from several threads.
+static QString dayOfMonthString(int day)
+{
+    switch (day) {
+    case -31:
+        return i18n("31st Last");
+    case -30:
+        return i18n("30th Last");
+    case -29:
+        return i18n("29th Last");
+    case -28:
+        return i18n("28th Last");
+    case -27:
+        return i18n("27th Last");
+    case -26:
+        return i18n("26th Last");
+    case -25:
+        return i18n("25th Last");
+    case -24:
+        return i18n("24th Last");
+    case -23:
+        return i18n("23rd Last");
+    case -22:
+        return i18n("22nd Last");
+    case -21:
+        return i18n("21st Last");
+    case -20:
+        return i18n("20th Last");
+    case -19:
+        return i18n("19th Last");
+    case -18:
+        return i18n("18th Last");
+    case -17:
+        return i18n("17th Last");
+    case -16:
+        return i18n("16th Last");
+    case -15:
+        return i18n("15th Last");
+    case -14:
+        return i18n("14th Last");
+    case -13:
+        return i18n("13th Last");
+    case -12:
+        return i18n("12th Last");
+    case -11:
+        return i18n("11th Last");
+    case -10:
+        return i18n("10th Last");
+    case -9:
+        return i18n("9th Last");
+    case -8:
+        return i18n("8th Last");
+    case -7:
+        return i18n("7th Last");
+    case -6:
+        return i18n("6th Last");
+    case -5:
+        return i18n("5th Last");
+    case -4:
+        return i18n("4th Last");
+    case -3:
+        return i18n("3rd Last");
+    case -2:
+        return i18n("2nd Last");
+    case -1:
+        return i18nc("last day of the month", "Last");
+    case 1:
+        return i18n("1st");
+    case 2:
+        return i18n("2nd");
+    case 3:
+        return i18n("3rd");
+    case 4:
+        return i18n("4th");
+    case 5:
+        return i18n("5th");
+    case 6:
+        return i18n("6th");
+    case 7:
+        return i18n("7th");
+    case 8:
+        return i18n("8th");
+    case 9:
+        return i18n("9th");
+    case 10:
+        return i18n("10th");
+    case 11:
+        return i18n("11th");
+    case 12:
+        return i18n("12th");
+    case 13:
+        return i18n("13th");
+    case 14:
+        return i18n("14th");
+    case 15:
+        return i18n("15th");
+    case 16:
+        return i18n("16th");
+    case 17:
+        return i18n("17th");
+    case 18:
+        return i18n("18th");
+    case 19:
+        return i18n("19th");
+    case 20:
+        return i18n("20th");
+    case 21:
+        return i18n("21st");
+    case 22:
+        return i18n("22nd");
+    case 23:
+        return i18n("23rd");
+    case 24:
+        return i18n("24th");
+    case 25:
+        return i18n("25th");
+    case 26:
+        return i18n("26th");
+    case 27:
+        return i18n("27th");
+    case 28:
+        return i18n("28th");
+    case 29:
+        return i18n("29th");
+    case 30:
+        return i18n("30th");
+    case 31:
+        return i18n("31st");
+    default:
+        return i18nc("unknown day of the month", "unknown");
+    }
+}
+//@endcond
+
 QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
 {
     if (incidence->hasRecurrenceId()) {
@@ -2935,72 +3293,6 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
     if (!incidence->recurs()) {
         return i18n("No recurrence");
     }
-    static QStringList dayList;
-    if (dayList.isEmpty()) {
-        dayList.append(i18n("31st Last"));
-        dayList.append(i18n("30th Last"));
-        dayList.append(i18n("29th Last"));
-        dayList.append(i18n("28th Last"));
-        dayList.append(i18n("27th Last"));
-        dayList.append(i18n("26th Last"));
-        dayList.append(i18n("25th Last"));
-        dayList.append(i18n("24th Last"));
-        dayList.append(i18n("23rd Last"));
-        dayList.append(i18n("22nd Last"));
-        dayList.append(i18n("21st Last"));
-        dayList.append(i18n("20th Last"));
-        dayList.append(i18n("19th Last"));
-        dayList.append(i18n("18th Last"));
-        dayList.append(i18n("17th Last"));
-        dayList.append(i18n("16th Last"));
-        dayList.append(i18n("15th Last"));
-        dayList.append(i18n("14th Last"));
-        dayList.append(i18n("13th Last"));
-        dayList.append(i18n("12th Last"));
-        dayList.append(i18n("11th Last"));
-        dayList.append(i18n("10th Last"));
-        dayList.append(i18n("9th Last"));
-        dayList.append(i18n("8th Last"));
-        dayList.append(i18n("7th Last"));
-        dayList.append(i18n("6th Last"));
-        dayList.append(i18n("5th Last"));
-        dayList.append(i18n("4th Last"));
-        dayList.append(i18n("3rd Last"));
-        dayList.append(i18n("2nd Last"));
-        dayList.append(i18nc("last day of the month", "Last"));
-        dayList.append(i18nc("unknown day of the month", "unknown")); //#31 - zero offset from UI
-        dayList.append(i18n("1st"));
-        dayList.append(i18n("2nd"));
-        dayList.append(i18n("3rd"));
-        dayList.append(i18n("4th"));
-        dayList.append(i18n("5th"));
-        dayList.append(i18n("6th"));
-        dayList.append(i18n("7th"));
-        dayList.append(i18n("8th"));
-        dayList.append(i18n("9th"));
-        dayList.append(i18n("10th"));
-        dayList.append(i18n("11th"));
-        dayList.append(i18n("12th"));
-        dayList.append(i18n("13th"));
-        dayList.append(i18n("14th"));
-        dayList.append(i18n("15th"));
-        dayList.append(i18n("16th"));
-        dayList.append(i18n("17th"));
-        dayList.append(i18n("18th"));
-        dayList.append(i18n("19th"));
-        dayList.append(i18n("20th"));
-        dayList.append(i18n("21st"));
-        dayList.append(i18n("22nd"));
-        dayList.append(i18n("23rd"));
-        dayList.append(i18n("24th"));
-        dayList.append(i18n("25th"));
-        dayList.append(i18n("26th"));
-        dayList.append(i18n("27th"));
-        dayList.append(i18n("28th"));
-        dayList.append(i18n("29th"));
-        dayList.append(i18n("30th"));
-        dayList.append(i18n("31st"));
-    }
 
     const int weekStart = QLocale().firstDayOfWeek();
     QString dayNames;
@@ -3008,10 +3300,9 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
     Recurrence *recur = incidence->recurrence();
 
     QString recurStr;
-    static QString noRecurrence = i18n("No recurrence");
     switch (recur->recurrenceType()) {
     case Recurrence::rNone:
-        return noRecurrence;
+        return i18n("No recurrence");
 
     case Recurrence::rMinutely:
         if (recur->duration() != -1) {
@@ -3085,7 +3376,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                     "Recurs every month on the %2 %3 until %4",
                     "Recurs every %1 months on the %2 %3 until %4",
                     recur->frequency(),
-                    dayList[rule.pos() + 31],
+                    dayOfMonthString(rule.pos()),
                     QLocale().dayName(rule.day(), QLocale::LongFormat),
                     recurEnd(incidence));
                 if (recur->duration() > 0) {
@@ -3096,7 +3387,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                                   "Recurs every month on the %2 %3",
                                   "Recurs every %1 months on the %2 %3",
                                   recur->frequency(),
-                                  dayList[rule.pos() + 31],
+                                  dayOfMonthString(rule.pos()),
                                   QLocale().dayName(rule.day(), QLocale::LongFormat));
             }
         }
@@ -3109,7 +3400,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                                   "Recurs monthly on the %2 day until %3",
                                   "Recurs every %1 months on the %2 day until %3",
                                   recur->frequency(),
-                                  dayList[days + 31],
+                                  dayOfMonthString(days),
                                   recurEnd(incidence));
                 if (recur->duration() > 0) {
                     recurStr += xi18nc("number of occurrences", " (%1 occurrences)", recur->duration());
@@ -3119,7 +3410,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                                   "Recurs monthly on the %2 day",
                                   "Recurs every %1 month on the %2 day",
                                   recur->frequency(),
-                                  dayList[days + 31]);
+                                  dayOfMonthString(days));
             }
         }
         break;
@@ -3133,7 +3424,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                     "Recurs every %1 years on %2 %3 until %4",
                     recur->frequency(),
                     QLocale().monthName(recur->yearMonths().at(0), QLocale::LongFormat),
-                    dayList.at(recur->yearDates().at(0) + 31),
+                    dayOfMonthString(recur->yearDates().at(0)),
                     recurEnd(incidence));
                 if (recur->duration() > 0) {
                     recurStr += i18nc("number of occurrences", " (%1 occurrences)", recur->duration());
@@ -3146,18 +3437,18 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                                   "Recurs every %1 years on %2 %3",
                                   recur->frequency(),
                                   QLocale().monthName(recur->yearMonths().at(0), QLocale::LongFormat),
-                                  dayList[recur->yearDates().at(0) + 31]);
+                                  dayOfMonthString(recur->yearDates().at(0)));
             } else {
                 if (!recur->yearMonths().isEmpty()) {
                     recurStr = i18nc("Recurs Every year on month-name [1st|2nd|...]",
                                      "Recurs yearly on %1 %2",
                                      QLocale().monthName(recur->yearMonths().at(0), QLocale::LongFormat),
-                                     dayList[recur->startDate().day() + 31]);
+                                     dayOfMonthString(recur->startDate().day()));
                 } else {
                     recurStr = i18nc("Recurs Every year on month-name [1st|2nd|...]",
                                      "Recurs yearly on %1 %2",
                                      QLocale().monthName(recur->startDate().month(), QLocale::LongFormat),
-                                     dayList[recur->startDate().day() + 31]);
+                                     dayOfMonthString(recur->startDate().day()));
                 }
             }
         }
@@ -3196,7 +3487,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                     "Every %1 years on the %2 %3 of %4"
                     " until %5",
                     recur->frequency(),
-                    dayList[rule.pos() + 31],
+                    dayOfMonthString(rule.pos()),
                     QLocale().dayName(rule.day(), QLocale::LongFormat),
                     QLocale().monthName(recur->yearMonths().at(0), QLocale::LongFormat),
                     recurEnd(incidence));
@@ -3210,7 +3501,7 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
                     "Every year on the %2 %3 of %4",
                     "Every %1 years on the %2 %3 of %4",
                     recur->frequency(),
-                    dayList[rule.pos() + 31],
+                    dayOfMonthString(rule.pos()),
                     QLocale().dayName(rule.day(), QLocale::LongFormat),
                     QLocale().monthName(recur->yearMonths().at(0), QLocale::LongFormat));
             }
@@ -3289,14 +3580,94 @@ QString IncidenceFormatter::recurrenceString(const Incidence::Ptr &incidence)
     return recurStr;
 }
 
+namespace
+{
+// The format strings of the default locale. Templates format many dates and
+// times in a row, so the strings are kept instead of being built from the
+// locale data on every call. QLocale::setDefault() sends no notification,
+// so each call still copies the default locale and compares it with the one
+// the strings belong to, which is cheaper than building the strings.
+// The system locale formats through the backend of the platform, which a
+// format string would bypass, so it is always asked directly.
+class LocaleFormats
+{
+public:
+    [[nodiscard]] static const LocaleFormats &current()
+    {
+        thread_local LocaleFormats formats;
+        const QLocale locale;
+        if (locale != formats.mLocale || !formats.mValid) {
+            formats.update(locale);
+        }
+        return formats;
+    }
+
+    [[nodiscard]] QString toString(QDate date, bool shortfmt) const
+    {
+        if (mSystem) {
+            return mLocale.toString(date, formatType(shortfmt));
+        }
+        return mLocale.toString(date, mDateFormats[shortfmt]);
+    }
+
+    [[nodiscard]] QString toString(QTime time, bool shortfmt) const
+    {
+        if (mSystem) {
+            return mLocale.toString(time, formatType(shortfmt));
+        }
+        return mLocale.toString(time, mTimeFormats[shortfmt]);
+    }
+
+    [[nodiscard]] QString toString(const QDateTime &dateTime, bool shortfmt) const
+    {
+        if (mSystem) {
+            return mLocale.toString(dateTime, formatType(shortfmt));
+        }
+        return mLocale.toString(dateTime, mDateTimeFormats[shortfmt]);
+    }
+
+private:
+    [[nodiscard]] static QLocale::FormatType formatType(bool shortfmt)
+    {
+        return shortfmt ? QLocale::ShortFormat : QLocale::LongFormat;
+    }
+
+    void update(const QLocale &locale)
+    {
+        mLocale = locale;
+        mSystem = locale == QLocale::system();
+        for (bool shortfmt : {false, true}) {
+            if (mSystem) {
+                mDateFormats[shortfmt].clear();
+                mTimeFormats[shortfmt].clear();
+                mDateTimeFormats[shortfmt].clear();
+                continue;
+            }
+            mDateFormats[shortfmt] = locale.dateFormat(formatType(shortfmt));
+            mTimeFormats[shortfmt] = locale.timeFormat(formatType(shortfmt));
+            mDateTimeFormats[shortfmt] = locale.dateTimeFormat(formatType(shortfmt));
+        }
+        mValid = true;
+    }
+
+    QLocale mLocale;
+    // Indexed by shortfmt, empty for the system locale
+    QString mDateFormats[2];
+    QString mTimeFormats[2];
+    QString mDateTimeFormats[2];
+    bool mSystem = false;
+    bool mValid = false;
+};
+}
+
 QString IncidenceFormatter::timeToString(QTime time, bool shortfmt)
 {
-    return QLocale().toString(time, shortfmt ? QLocale::ShortFormat : QLocale::LongFormat);
+    return LocaleFormats::current().toString(time, shortfmt);
 }
 
 QString IncidenceFormatter::dateToString(QDate date, bool shortfmt)
 {
-    return QLocale().toString(date, (shortfmt ? QLocale::ShortFormat : QLocale::LongFormat));
+    return LocaleFormats::current().toString(date, shortfmt);
 }
 
 QString IncidenceFormatter::dateTimeToString(const QDateTime &date, bool allDay, bool shortfmt)
@@ -3305,7 +3676,7 @@ QString IncidenceFormatter::dateTimeToString(const QDateTime &date, bool allDay,
         return dateToString(date.toLocalTime().date(), shortfmt);
     }
 
-    return QLocale().toString(date.toLocalTime(), (shortfmt ? QLocale::ShortFormat : QLocale::LongFormat));
+    return LocaleFormats::current().toString(date.toLocalTime(), shortfmt);
 }
 
 QString IncidenceFormatter::resourceString(const Calendar::Ptr &calendar, const Incidence::Ptr &incidence)
@@ -3450,3 +3821,112 @@ QStringList IncidenceFormatter::reminderStringList(const Incidence::Ptr &inciden
 
     return reminderStringList;
 }
+
+/*******************************************************************
+ *  Warm-up
+ *******************************************************************/
+
+namespace
+{
+// Progress of warmUp(), whose steps finish on different threads
+class WarmUpProgress
+{
+public:
+    explicit WarmUpProgress(int steps)
+        : mSteps(steps)
+    {
+        mPromise.setProgressRange(0, steps);
+        mPromise.start();
+    }
+
+    QFuture<void> future()
+    {
+        return mPromise.future();
+    }
+
+    void stepDone()
+    {
+        QMutexLocker locker(&mMutex);
+        mPromise.setProgressValue(++mDone);
+        if (mDone == mSteps) {
+            mPromise.finish();
+        }
+    }
+
+private:
+    QMutex mMutex;
+    QPromise<void> mPromise;
+    const int mSteps;
+    int mDone = 0;
+};
+}
+
+QFuture<void> IncidenceFormatter::warmUp(QThread *thread)
+{
+    static QMutex mutex;
+    static QFuture<void> future;
+
+    QMutexLocker locker(&mutex);
+    if (future.isValid()) {
+        return future;
+    }
+
+    const QCoreApplication *app = QCoreApplication::instance();
+    if (!thread) {
+        thread = app ? app->thread() : QThread::currentThread();
+    }
+
+    auto progress = std::make_shared<WarmUpProgress>(3);
+    future = progress->future();
+
+    // The GUI providers and the icon theme are not meant to be used from a
+    // pool thread that goes away, so the icons are looked up on the thread
+    // that formats, once it processes its events
+    if (app) {
+        auto *context = new QObject;
+        context->moveToThread(thread);
+        QMetaObject::invokeMethod(
+            context,
+            [progress, context]() {
+                Tracing::TraceSpan span("warmUp icons");
+
+                // Loads the providers and looks up the tooltip icons, with
+                // the arguments the tooltips use
+                for (int status = Attendee::NeedsAction; status <= Attendee::InProcess; ++status) {
+                    const QString path = tooltipStatusIconPath(static_cast<Attendee::PartStat>(status));
+                    Q_UNUSED(path)
+                }
+                const QString organizerPath = tooltipOrganizerIconPath();
+                Q_UNUSED(organizerPath)
+                context->deleteLater();
+                progress->stepDone();
+            },
+            Qt::QueuedConnection);
+    } else {
+        // Without an application there are only the built-in providers
+        progress->stepDone();
+    }
+
+    QThreadPool::globalInstance()->start([progress, thread]() {
+        Tracing::TraceSpan span("warmUp");
+
+        // Loads the translation catalog
+        const QString translated = i18n("Template");
+        Q_UNUSED(translated)
+        progress->stepDone();
+
+        // Sets up the template engine and parses the templates
+        GrantleeTemplateManager::prepare({QStringLiteral(":/event.html"),
+                                          QStringLiteral(":/todo.html"),
+                                          QStringLiteral(":/journal.html"),
+                                          QStringLiteral(":/freebusy.html"),
+                                          QStringLiteral(":/itip.html"),
+                                          QStringLiteral(":/itip_event.html"),
+                                          QStringLiteral(":/itip_todo.html"),
+                                          QStringLiteral(":/itip_journal.html"),
+                                          QStringLiteral(":/itip_freebusy.html")},
+                                         thread);
+        progress->stepDone();
+    });
+    return future;
+}
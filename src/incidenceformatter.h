@@ -18,15 +18,19 @@
 */
 #pragma once
 
-#include "kcalutils_export.h"
+#include "kcalutilscore_export.h"
 
 #include <KCalendarCore/Calendar>
 #include <KCalendarCore/Incidence>
 
 #include <QDate>
+#include <QFuture>
 
+#include <atomic>
 #include <memory>
 
+class QThread;
+
 namespace KCalUtils
 {
 class InvitationFormatterHelperPrivate;
@@ -34,7 +38,7 @@ class InvitationFormatterHelperPrivate;
 /**
  * @brief The InvitationFormatterHelper class
  */
-class KCALUTILS_EXPORT InvitationFormatterHelper
+class KCALUTILSCORE_EXPORT InvitationFormatterHelper
 {
 public:
     InvitationFormatterHelper();
@@ -58,6 +62,13 @@ private:
   different ways: like an HTML representation for KMail, a representation
   for tool tips, or a representation for a viewer widget.
 
+  The functions are reentrant: they may be called from several threads at
+  once, as long as each thread formats its own incidences and calendars.
+  One exception is the check whether the user is the organizer or an
+  attendee, which goes through the process-wide
+  KIdentityManagementCore::IdentityManager::self(). That singleton is not
+  thread-safe. Create it on the main thread before other threads format
+  incidences, and do not change the identities while they do.
 */
 namespace IncidenceFormatter
 {
@@ -72,7 +83,7 @@ namespace IncidenceFormatter
   start date and the due date (inclusive) of the occurrence.
   @param richText if yes, the QString will be created as RichText.
 */
-KCALUTILS_EXPORT QString toolTipStr(const QString &sourceName, const KCalendarCore::IncidenceBase::Ptr &incidence, QDate date = QDate(), bool richText = true);
+KCALUTILSCORE_EXPORT QString toolTipStr(const QString &sourceName, const KCalendarCore::IncidenceBase::Ptr &incidence, QDate date = QDate(), bool richText = true);
 
 /**
   Create a RichText QString representation of an Incidence in a nice format
@@ -83,7 +94,7 @@ KCALUTILS_EXPORT QString toolTipStr(const QString &sourceName, const KCalendarCo
   @param date is the QDate for which the string representation should be computed;
   used mainly for recurring incidences.
 */
-KCALUTILS_EXPORT QString extensiveDisplayStr(const KCalendarCore::Calendar::Ptr &calendar,
+KCALUTILSCORE_EXPORT QString extensiveDisplayStr(const KCalendarCore::Calendar::Ptr &calendar,
                                              const KCalendarCore::IncidenceBase::Ptr &incidence,
                                              QDate date = QDate());
 
@@ -96,7 +107,7 @@ KCALUTILS_EXPORT QString extensiveDisplayStr(const KCalendarCore::Calendar::Ptr
   @param date is the QDate for which the string representation should be computed;
   used mainly for recurring incidences.
 */
-KCALUTILS_EXPORT QString extensiveDisplayStr(const QString &sourceName, const KCalendarCore::IncidenceBase::Ptr &incidence, QDate date = QDate());
+KCALUTILSCORE_EXPORT QString extensiveDisplayStr(const QString &sourceName, const KCalendarCore::IncidenceBase::Ptr &incidence, QDate date = QDate());
 
 /**
   Create a QString representation of an Incidence in format suitable for
@@ -104,7 +115,7 @@ KCALUTILS_EXPORT QString extensiveDisplayStr(const QString &sourceName, const KC
   All dates and times are converted to local time for display.
   @param incidence is a pointer to the Incidence to be formatted.
 */
-KCALUTILS_EXPORT QString mailBodyStr(const KCalendarCore::IncidenceBase::Ptr &incidence);
+KCALUTILSCORE_EXPORT QString mailBodyStr(const KCalendarCore::IncidenceBase::Ptr &incidence);
 
 /**
   Deliver an HTML formatted string displaying an invitation.
@@ -117,7 +128,7 @@ KCALUTILS_EXPORT QString mailBodyStr(const KCalendarCore::IncidenceBase::Ptr &in
 
   @since 5.23.0
 */
-KCALUTILS_EXPORT QString formatICalInvitation(const QString &invitation, const KCalendarCore::Calendar::Ptr &calendar, InvitationFormatterHelper *helper);
+KCALUTILSCORE_EXPORT QString formatICalInvitation(const QString &invitation, const KCalendarCore::Calendar::Ptr &calendar, InvitationFormatterHelper *helper);
 
 /**
   Deliver an HTML formatted string displaying an invitation.
@@ -133,7 +144,7 @@ KCALUTILS_EXPORT QString formatICalInvitation(const QString &invitation, const K
 
   @since 5.23.0
 */
-KCALUTILS_EXPORT QString formatICalInvitationNoHtml(const QString &invitation,
+KCALUTILSCORE_EXPORT QString formatICalInvitationNoHtml(const QString &invitation,
                                                     const KCalendarCore::Calendar::Ptr &calendar,
                                                     InvitationFormatterHelper *helper,
                                                     const QString &sender);
@@ -143,7 +154,7 @@ KCALUTILS_EXPORT QString formatICalInvitationNoHtml(const QString &invitation,
   @param incidence is a pointer to the Incidence whose recurrence info
   is to be formatted.
 */
-KCALUTILS_EXPORT QString recurrenceString(const KCalendarCore::Incidence::Ptr &incidence);
+KCALUTILSCORE_EXPORT QString recurrenceString(const KCalendarCore::Incidence::Ptr &incidence);
 
 /**
   Returns a reminder string computed for the specified Incidence.
@@ -153,7 +164,7 @@ KCALUTILS_EXPORT QString recurrenceString(const KCalendarCore::Incidence::Ptr &i
   @param shortfmt if false, a short version of each reminder is printed;
   else a longer version of each reminder is printed.
 */
-KCALUTILS_EXPORT QStringList reminderStringList(const KCalendarCore::Incidence::Ptr &incidence, bool shortfmt = true);
+KCALUTILSCORE_EXPORT QStringList reminderStringList(const KCalendarCore::Incidence::Ptr &incidence, bool shortfmt = true);
 
 /**
   Build a QString time representation of a QTime object.
@@ -161,7 +172,7 @@ KCALUTILS_EXPORT QStringList reminderStringList(const KCalendarCore::Incidence::
   @param shortfmt If true, display info in short format.
   @see dateToString(), dateTimeToString().
 */
-KCALUTILS_EXPORT QString timeToString(QTime time, bool shortfmt = true);
+KCALUTILSCORE_EXPORT QString timeToString(QTime time, bool shortfmt = true);
 
 /**
   Build a QString date representation of a QDate object.
@@ -170,9 +181,9 @@ KCALUTILS_EXPORT QString timeToString(QTime time, bool shortfmt = true);
   @param shortfmt If true, display info in short format.
   @see dateToString(), dateTimeToString().
 */
-KCALUTILS_EXPORT QString dateToString(QDate date, bool shortfmt = true);
+KCALUTILSCORE_EXPORT QString dateToString(QDate date, bool shortfmt = true);
 
-KCALUTILS_EXPORT QString formatStartEnd(const QDateTime &start, const QDateTime &end, bool isAllDay);
+KCALUTILSCORE_EXPORT QString formatStartEnd(const QDateTime &start, const QDateTime &end, bool isAllDay);
 
 /**
   Build a QString date/time representation of a QDateTime object.
@@ -182,21 +193,287 @@ KCALUTILS_EXPORT QString formatStartEnd(const QDateTime &start, const QDateTime
   @param shortfmt If true, display info in short format.
   @see dateToString(), timeToString().
 */
-KCALUTILS_EXPORT QString dateTimeToString(const QDateTime &date, bool dateOnly = false, bool shortfmt = true);
+KCALUTILSCORE_EXPORT QString dateTimeToString(const QDateTime &date, bool dateOnly = false, bool shortfmt = true);
 
 /**
   Returns a Calendar Resource label name for the specified Incidence.
   @param calendar is a pointer to the Calendar.
   @param incidence is a pointer to the Incidence.
 */
-KCALUTILS_EXPORT QString resourceString(const KCalendarCore::Calendar::Ptr &calendar, const KCalendarCore::Incidence::Ptr &incidence);
+KCALUTILSCORE_EXPORT QString resourceString(const KCalendarCore::Calendar::Ptr &calendar, const KCalendarCore::Incidence::Ptr &incidence);
 
 /**
   Returns a duration string computed for the specified Incidence.
   Only makes sense for Events and Todos.
   @param incidence is a pointer to the Incidence.
 */
-KCALUTILS_EXPORT QString durationString(const KCalendarCore::Incidence::Ptr &incidence);
+KCALUTILSCORE_EXPORT QString durationString(const KCalendarCore::Incidence::Ptr &incidence);
+
+/**
+  Prepares the formatters in the background, so that the first formatted
+  incidence is not delayed by one-time setup: creating the template engine,
+  loading its plugins, parsing the templates, loading the translations and
+  looking up the icons.
+
+  The template engine and the templates are QObjects that belong to one
+  thread. Once prepared, they are handed over to @p thread and used when it
+  formats its first incidence; other threads set up their own as before.
+  Calling this function again returns the future of the first call and
+  ignores @p thread.
+
+  The templates are parsed on a thread of the global thread pool. The
+  icons are looked up on @p thread, from its event loop, so the future
+  finishes only once @p thread processes its events; @p thread must not
+  block waiting for it.
+
+  @param thread the thread that will format the incidences; by default the
+  thread of the application object, or the calling thread without one.
+  @return a future that finishes when the preparation is done; its progress
+  can be followed with a QFutureWatcher.
+*/
+KCALUTILSCORE_EXPORT QFuture<void> warmUp(QThread *thread = nullptr);
+
+class StatisticsPrivate;
+
+/**
+  @brief
+  Cumulative counters of the formatting functions, for processes that want
+  to expose them through their own monitoring.
+
+  A Statistics object is a snapshot taken by statistics(); it does not
+  change afterwards.
+  @see statistics(), resetStatistics()
+*/
+class KCALUTILSCORE_EXPORT Statistics
+{
+public:
+    /// The public functions whose calls are counted
+    enum EntryPoint {
+        ExtensiveDisplay, ///< extensiveDisplayStr()
+        ToolTip, ///< toolTipStr()
+        MailBody, ///< mailBodyStr()
+        Invitation, ///< formatICalInvitation()
+        InvitationNoHtml, ///< formatICalInvitationNoHtml()
+        EntryPointCount
+    };
+
+    /// The phases whose time is accumulated
+    enum Phase {
+        ParsePhase, ///< Parsing of invitations
+        LookupPhase, ///< Searching the calendar for related incidences
+        RenderPhase, ///< Loading and rendering templates
+        PhaseCount
+    };
+
+    /// Creates a snapshot with all counters at zero
+    Statistics();
+    Statistics(const Statistics &other);
+    Statistics &operator=(const Statistics &other);
+    ~Statistics();
+
+    /// Number of calls of @p entryPoint
+    [[nodiscard]] quint64 calls(EntryPoint entryPoint) const;
+    /// Total time spent in @p entryPoint, in nanoseconds
+    [[nodiscard]] quint64 callNanoseconds(EntryPoint entryPoint) const;
+    /// Total size of the strings returned by @p entryPoint, in bytes
+    [[nodiscard]] quint64 bytesProduced(EntryPoint entryPoint) const;
+    /// Number of heap allocations made by @p entryPoint, see setAllocationProbe()
+    [[nodiscard]] quint64 allocations(EntryPoint entryPoint) const;
+    /// Total bytes allocated by @p entryPoint, see setAllocationProbe()
+    [[nodiscard]] quint64 allocatedBytes(EntryPoint entryPoint) const;
+    /// Largest growth of the heap during a single call of @p entryPoint,
+    /// in bytes, see setAllocationProbe()
+    [[nodiscard]] quint64 peakBytes(EntryPoint entryPoint) const;
+    /// Total time spent in @p phase, in nanoseconds
+    [[nodiscard]] quint64 phaseNanoseconds(Phase phase) const;
+    /// Number of invitations parsed
+    [[nodiscard]] quint64 invitationParses() const;
+    /// Number of templates that were found in the template cache
+    [[nodiscard]] quint64 templateCacheHits() const;
+    /// Number of templates that had to be loaded and parsed
+    [[nodiscard]] quint64 templateCacheMisses() const;
+    /// Approximate memory held by the caches of the library, in bytes.
+    /// This is the current value; it is not affected by resetStatistics().
+    [[nodiscard]] quint64 cacheMemory() const;
+
+private:
+    friend class StatisticsPrivate;
+    std::unique_ptr<StatisticsPrivate> d;
+};
+
+/**
+  Returns a snapshot of the counters accumulated since the library was
+  loaded or since the last call to resetStatistics().
+  This function is thread-safe.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT Statistics statistics();
+
+/**
+  Resets all cumulative counters to zero.
+  This function is thread-safe.
+*/
+KCALUTILSCORE_EXPORT void resetStatistics();
+
+/**
+  @brief
+  Gives access to the heap allocation counters of the calling thread.
+
+  The library does not count allocations itself. A probe is provided by
+  whoever replaces the allocation functions of the process, typically a
+  benchmark or fuzzing helper, and installed with setAllocationProbe().
+*/
+class KCALUTILSCORE_EXPORT AllocationProbe
+{
+public:
+    virtual ~AllocationProbe();
+
+    /// Number of allocations made by the calling thread so far
+    [[nodiscard]] virtual quint64 allocations() const = 0;
+    /// Bytes allocated by the calling thread so far
+    [[nodiscard]] virtual quint64 allocatedBytes() const = 0;
+    /// Bytes allocated minus bytes freed by the calling thread
+    [[nodiscard]] virtual qint64 liveBytes() const = 0;
+    /// Highest value of liveBytes() since the last call to resetPeak()
+    [[nodiscard]] virtual qint64 peakLiveBytes() const = 0;
+    /// Makes peakLiveBytes() equal to liveBytes()
+    virtual void resetPeak() = 0;
+};
+
+/**
+  Installs @p probe to account the allocations of every call counted in
+  Statistics, or removes the probe if @p probe is nullptr.
+  The probe is not owned and must stay valid until it is removed. It must
+  not be changed while formatting functions run on other threads.
+*/
+KCALUTILSCORE_EXPORT void setAllocationProbe(AllocationProbe *probe);
+
+/**
+  @brief
+  Provides the colors used in the formatted HTML.
+
+  The default implementation returns fixed colors that do not depend on
+  any GUI state. Applications with a QGuiApplication get the colors of the
+  application palette instead, unless they install their own provider.
+  The palette is read on the thread of the application object, when it
+  first formats an incidence or processes its events after another thread
+  did, and again whenever the palette changes; until then other threads
+  get the fixed colors.
+*/
+class KCALUTILSCORE_EXPORT ColorProvider
+{
+public:
+    enum ColorRole {
+        DiffColor, ///< Changed values in updated invitations
+        NoteColor, ///< Notes added to invitations
+        ButtonBackgroundColor, ///< Background of the invitation buttons
+        ButtonBorderColor, ///< Border of the invitation buttons
+        ButtonTextColor, ///< Text of the invitation buttons
+    };
+
+    virtual ~ColorProvider();
+
+    /// Returns the color for @p role as an HTML color name, e.g. "#ff0000"
+    [[nodiscard]] virtual QString color(ColorRole role) const;
+};
+
+/**
+  @brief
+  Resolves the icons used in the formatted HTML.
+
+  The default implementation resolves no icon at all, so that formatting
+  works in processes without a QGuiApplication. Applications with a
+  QGuiApplication look the icons up with KIconLoader instead, unless they
+  install their own provider. KIconLoader is set up on the thread of the
+  application object, like the colors of ColorProvider, and other threads
+  resolve no icons until then; its lookups are serialized.
+*/
+class KCALUTILSCORE_EXPORT IconProvider
+{
+public:
+    IconProvider();
+    virtual ~IconProvider();
+
+    /**
+      Returns the path of the icon @p name, or an empty string to leave the
+      icon out.
+      @param sizeOrGroup a KIconLoader::Group or a size in pixels
+      @param canReturnNull if false, a placeholder icon should be returned
+      for unknown icons rather than an empty string
+    */
+    [[nodiscard]] virtual QString iconPath(const QString &name, int sizeOrGroup, bool canReturnNull) const;
+
+    /**
+      Returns the size in pixels of the icons in @p sizeOrGroup.
+      @param sizeOrGroup a KIconLoader::Group or a size in pixels
+    */
+    [[nodiscard]] virtual int iconSize(int sizeOrGroup) const;
+
+    /**
+      Returns a number that changes whenever paths returned by iconPath()
+      may have become stale, e.g. after the icon theme was changed.
+      Revisions are unique across all providers, so callers that keep icon
+      paths compare it to decide when to look them up again.
+    */
+    [[nodiscard]] quint64 revision() const;
+
+protected:
+    /**
+      Marks all icon paths returned so far as stale.
+      Providers with a cache call this when the icon theme changes.
+    */
+    void iconsChanged();
+
+private:
+    std::atomic<quint64> mRevision;
+};
+
+/**
+  Installs @p provider for the colors of the formatted HTML, or restores
+  the default provider if @p provider is nullptr.
+  The provider is not owned and must stay valid until it is removed. It is
+  called from every thread that formats incidences.
+*/
+KCALUTILSCORE_EXPORT void setColorProvider(ColorProvider *provider);
+
+/**
+  Returns the color provider in use.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT const ColorProvider *colorProvider();
+
+/**
+  Installs @p provider for the icons of the formatted HTML, or restores
+  the default provider if @p provider is nullptr.
+  The provider is not owned and must stay valid until it is removed. It is
+  called from every thread that formats incidences.
+*/
+KCALUTILSCORE_EXPORT void setIconProvider(IconProvider *provider);
+
+/**
+  Returns the icon provider in use.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT const IconProvider *iconProvider();
+
+/**
+  How the icons are referenced in the formatted HTML.
+  @see setIconMode()
+*/
+enum IconMode {
+    IconFilePaths, ///< Paths of the icon files, for display on the same machine (default)
+    IconDataUris, ///< data: URIs with the icon embedded, for HTML sent elsewhere
+};
+
+/**
+  Sets how the icons are referenced in the formatted HTML.
+  In IconDataUris mode, each icon file is read and encoded only once until
+  the icons of the icon provider change; the encoded icons are shared by
+  all threads.
+*/
+KCALUTILSCORE_EXPORT void setIconMode(IconMode mode);
+
+/**
+  Returns how the icons are referenced in the formatted HTML.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT IconMode iconMode();
 
 class EventViewerVisitor;
 template<typename T>
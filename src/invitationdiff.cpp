@@ -0,0 +1,132 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "invitationdiff_p.h"
+
+#include <KCalendarCore/Alarm>
+#include <KCalendarCore/Recurrence>
+#include <KCalendarCore/Todo>
+using namespace KCalendarCore;
+
+#include <QHash>
+
+using namespace KCalUtils;
+
+static bool sameAlarms(const Alarm::List &alarms, const Alarm::List &oldAlarms)
+{
+    if (alarms.count() != oldAlarms.count()) {
+        return false;
+    }
+    for (int i = 0, total = alarms.count(); i < total; ++i) {
+        if (!(*alarms.at(i) == *oldAlarms.at(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+InvitationDiff::InvitationDiff(const Incidence::Ptr &incidence, const Incidence::Ptr &oldIncidence)
+{
+    if (!incidence || !oldIncidence) {
+        return;
+    }
+
+    if (incidence->summary() != oldIncidence->summary() || incidence->summaryIsRich() != oldIncidence->summaryIsRich()) {
+        mChangedFields |= Summary;
+    }
+    if (incidence->location() != oldIncidence->location() || incidence->locationIsRich() != oldIncidence->locationIsRich()) {
+        mChangedFields |= Location;
+    }
+    if (incidence->description() != oldIncidence->description() || incidence->descriptionIsRich() != oldIncidence->descriptionIsRich()) {
+        mChangedFields |= Description;
+    }
+    if (incidence->dtStart() != oldIncidence->dtStart()) {
+        mChangedFields |= DtStart;
+    }
+    if (incidence->dateTime(Incidence::RoleEnd) != oldIncidence->dateTime(Incidence::RoleEnd)) {
+        mChangedFields |= DtEnd;
+    }
+    if (incidence->allDay() != oldIncidence->allDay()) {
+        mChangedFields |= AllDay;
+    }
+    if (incidence->recurs() != oldIncidence->recurs()
+        || (incidence->recurs() && !(*incidence->recurrence() == *oldIncidence->recurrence()))) {
+        mChangedFields |= Recurrence;
+    }
+    if (!sameAlarms(incidence->alarms(), oldIncidence->alarms())) {
+        mChangedFields |= Alarms;
+    }
+    if (incidence->priority() != oldIncidence->priority()) {
+        mChangedFields |= Priority;
+    }
+    if (incidence->categories() != oldIncidence->categories()) {
+        mChangedFields |= Categories;
+    }
+
+    const Todo::Ptr todo = incidence.dynamicCast<Todo>();
+    const Todo::Ptr oldTodo = oldIncidence.dynamicCast<Todo>();
+    if (todo && oldTodo && todo->percentComplete() != oldTodo->percentComplete()) {
+        mChangedFields |= PercentComplete;
+    }
+
+    compareAttendees(incidence->attendees(), oldIncidence->attendees());
+}
+
+void InvitationDiff::compareAttendees(const Attendee::List &attendees, const Attendee::List &oldAttendees)
+{
+    // Attendees are matched by email address, their order does not matter
+    QHash<QString, int> oldByEmail;
+    oldByEmail.reserve(oldAttendees.count());
+    for (int i = 0, total = oldAttendees.count(); i < total; ++i) {
+        oldByEmail.insert(oldAttendees.at(i).email().toLower(), i);
+    }
+
+    QList<bool> matched(oldAttendees.count(), false);
+    for (const Attendee &attendee : attendees) {
+        const auto it = oldByEmail.constFind(attendee.email().toLower());
+        if (it == oldByEmail.constEnd()) {
+            mAttendeeChanges.push_back({AttendeeChange::Added, attendee, Attendee::None});
+            continue;
+        }
+        matched[it.value()] = true;
+        const Attendee &oldAttendee = oldAttendees.at(it.value());
+        if (attendee.status() != oldAttendee.status()) {
+            mAttendeeChanges.push_back({AttendeeChange::StatusChanged, attendee, oldAttendee.status()});
+        } else if (!(attendee == oldAttendee)) {
+            // Role, name or RSVP changes are not listed, but still count as a change
+            mChangedFields |= Attendees;
+        }
+    }
+    for (int i = 0, total = oldAttendees.count(); i < total; ++i) {
+        if (!matched.at(i)) {
+            mAttendeeChanges.push_back({AttendeeChange::Removed, oldAttendees.at(i), oldAttendees.at(i).status()});
+        }
+    }
+
+    if (!mAttendeeChanges.isEmpty()) {
+        mChangedFields |= Attendees;
+    }
+}
+
+bool InvitationDiff::hasChanges() const
+{
+    return mChangedFields != NoField;
+}
+
+InvitationDiff::Fields InvitationDiff::changedFields() const
+{
+    return mChangedFields;
+}
+
+bool InvitationDiff::isChanged(Fields fields) const
+{
+    return mChangedFields & fields;
+}
+
+QList<InvitationDiff::AttendeeChange> InvitationDiff::attendeeChanges() const
+{
+    return mAttendeeChanges;
+}
@@ -0,0 +1,80 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kcalutils_private_export.h"
+
+#include <KCalendarCore/Attendee>
+#include <KCalendarCore/Incidence>
+
+#include <QFlags>
+#include <QList>
+
+namespace KCalUtils
+{
+/**
+  Field-level comparison of an incidence from an invitation update against
+  the version already stored in the calendar.
+
+  The comparison is done once, directly on the incidences, so the invitation
+  formatter only has to format the old value of fields that actually changed.
+*/
+class KCALUTILS_TESTS_EXPORT InvitationDiff
+{
+public:
+    enum Field {
+        NoField = 0,
+        Summary = 0x1,
+        Location = 0x2,
+        Description = 0x4,
+        DtStart = 0x8,
+        DtEnd = 0x10, // the end of an event, the due date of a to-do
+        AllDay = 0x20,
+        Recurrence = 0x40,
+        Attendees = 0x80,
+        Alarms = 0x100,
+        PercentComplete = 0x200,
+        Priority = 0x400,
+        Categories = 0x800,
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    struct AttendeeChange {
+        enum Type {
+            Added,
+            Removed,
+            StatusChanged,
+        };
+        Type type;
+        KCalendarCore::Attendee attendee; // the new attendee, or the removed one
+        KCalendarCore::Attendee::PartStat oldStatus;
+    };
+
+    InvitationDiff() = default;
+    /**
+      Compares @p incidence with @p oldIncidence. A null @p oldIncidence
+      means there is nothing to compare with and results in an empty diff.
+    */
+    InvitationDiff(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Incidence::Ptr &oldIncidence);
+
+    [[nodiscard]] bool hasChanges() const;
+    [[nodiscard]] Fields changedFields() const;
+    /**
+      Returns true if any of @p fields has changed.
+    */
+    [[nodiscard]] bool isChanged(Fields fields) const;
+    [[nodiscard]] QList<AttendeeChange> attendeeChanges() const;
+
+private:
+    void compareAttendees(const KCalendarCore::Attendee::List &attendees, const KCalendarCore::Attendee::List &oldAttendees);
+
+    Fields mChangedFields;
+    QList<AttendeeChange> mAttendeeChanges;
+};
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KCalUtils::InvitationDiff::Fields)
@@ -6,12 +6,12 @@
 
 #pragma once
 
-#include "kcalutils_export.h"
+#include "kcalutilscore_export.h"
 
 /* Classes which are exported only for unit tests */
 #ifdef BUILD_TESTING
 #ifndef KCALUTILS_TESTS_EXPORT
-#define KCALUTILS_TESTS_EXPORT KCALUTILS_EXPORT
+#define KCALUTILS_TESTS_EXPORT KCALUTILSCORE_EXPORT
 #endif
 #else /* not compiling tests */
 #define KCALUTILS_TESTS_EXPORT
@@ -6,10 +6,14 @@
  */
 
 #include "qtresourcetemplateloader.h"
+#include "formatterstatistics_p.h"
 
 #include <KTextTemplate/Engine>
+#include <KTextTemplate/Template>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
+#include <QThread>
 // TODO: remove this class when Grantlee support it
 using namespace KCalUtils;
 QtResourceTemplateLoader::QtResourceTemplateLoader(const QSharedPointer<KTextTemplate::AbstractLocalizer> &localizer)
@@ -19,36 +23,209 @@ QtResourceTemplateLoader::QtResourceTemplateLoader(const QSharedPointer<KTextTem
 
 KTextTemplate::Template QtResourceTemplateLoader::loadByName(const QString &fileName, const KTextTemplate::Engine *engine) const
 {
+    QMutexLocker locker(&mCacheMutex);
+    useEngineLocked(engine);
+
     // Qt resource file
     if (fileName.startsWith(QLatin1String(":/"))) {
+        const auto it = mCache.constFind(fileName);
+        if (it != mCache.constEnd()) {
+            FormatterStatistics::countTemplateLookup(true);
+            return it.value();
+        }
+        if (!resourceExistsLocked(fileName)) {
+            return KTextTemplate::Template();
+        }
+        // Parsing loads the included and extended templates through this loader
+        locker.unlock();
+
         QFile file;
         file.setFileName(fileName);
-        if (!file.exists() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
             return KTextTemplate::Template();
         }
 
         QTextStream fstream(&file);
         const auto fileContent = fstream.readAll();
 
-        return engine->newTemplate(fileContent, fileName);
+        FormatterStatistics::countTemplateLookup(false);
+        KTextTemplate::Template tpl = engine->newTemplate(fileContent, fileName);
+
+        // Templates that fail to parse are kept too, they would fail again
+        locker.relock();
+        if (!mCache.contains(fileName)) {
+            // The size of the source is used as an estimate of the parsed template
+            addCacheMemoryLocked((fileName.size() + fileContent.size()) * qint64(sizeof(QChar)));
+        }
+        mCache.insert(fileName, tpl);
+        return tpl;
     } else {
-        return KTextTemplate::FileSystemTemplateLoader::loadByName(fileName, engine);
+        const QString path = filePathLocked(fileName);
+        if (path.isEmpty()) {
+            return KTextTemplate::Template();
+        }
+
+        // Custom themes may be edited while the application runs, but
+        // checking the file on every render would cost a stat() each time
+        const auto it = mFileTemplates.find(path);
+        if (it != mFileTemplates.end() && !it->revalidate.hasExpired()) {
+            FormatterStatistics::countTemplateLookup(true);
+            return it->tpl;
+        }
+        const QFileInfo info(path);
+        if (!info.exists()) {
+            forgetFileLocked(fileName);
+            return KTextTemplate::Template();
+        }
+        const QDateTime lastModified = info.lastModified();
+        if (it != mFileTemplates.end() && it->lastModified == lastModified) {
+            it->revalidate.setRemainingTime(revalidateInterval);
+            FormatterStatistics::countTemplateLookup(true);
+            return it->tpl;
+        }
+        locker.unlock();
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            locker.relock();
+            forgetFileLocked(fileName);
+            return KTextTemplate::Template();
+        }
+        QTextStream fstream(&file);
+        const auto fileContent = fstream.readAll();
+
+        FormatterStatistics::countTemplateLookup(false);
+        KTextTemplate::Template tpl = engine->newTemplate(fileContent, fileName);
+
+        locker.relock();
+        const qint64 size = (path.size() + fileContent.size()) * qint64(sizeof(QChar));
+        addCacheMemoryLocked(size - mFileTemplates.value(path).size);
+        mFileTemplates.insert(path, {lastModified, tpl, size, QDeadlineTimer(revalidateInterval)});
+        return tpl;
+    }
+}
+
+void QtResourceTemplateLoader::clearCache()
+{
+    QMutexLocker locker(&mCacheMutex);
+    clearCacheLocked();
+}
+
+void QtResourceTemplateLoader::moveToThread(QThread *thread)
+{
+    QMutexLocker locker(&mCacheMutex);
+    for (const KTextTemplate::Template &tpl : std::as_const(mCache)) {
+        if (tpl) {
+            tpl->moveToThread(thread);
+        }
+    }
+    for (const FileTemplate &fileTemplate : std::as_const(mFileTemplates)) {
+        if (fileTemplate.tpl) {
+            fileTemplate.tpl->moveToThread(thread);
+        }
+    }
+}
+
+void QtResourceTemplateLoader::clearCacheLocked() const
+{
+    mCache.clear();
+    mResources.clear();
+    mFilePaths.clear();
+    mFileTemplates.clear();
+    mCacheEngine = nullptr;
+    FormatterStatistics::addCacheMemory(-mCacheMemory);
+    mCacheMemory = 0;
+}
+
+void QtResourceTemplateLoader::useEngineLocked(const KTextTemplate::Engine *engine) const
+{
+    if (engine != mCacheEngine) {
+        clearCacheLocked();
+        mCacheEngine = engine;
+    }
+}
+
+bool QtResourceTemplateLoader::resourceExistsLocked(const QString &name) const
+{
+    auto it = mResources.constFind(name);
+    if (it == mResources.constEnd()) {
+        it = mResources.insert(name, QFile::exists(name));
     }
+    return *it;
+}
+
+QString QtResourceTemplateLoader::filePathLocked(const QString &name) const
+{
+    auto it = mFilePaths.find(name);
+    if (it != mFilePaths.end()) {
+        // Found templates are checked by loadByName()
+        if (!it->path.isEmpty() || !it->revalidate.hasExpired()) {
+            return it->path;
+        }
+        if (it->directoryTimes == themeDirectoryTimes()) {
+            it->revalidate.setRemainingTime(revalidateInterval);
+            return it->path;
+        }
+        // A file was added to or removed from the theme, look again
+        forgetFileLocked(name);
+    }
+
+    // Same lookup as KTextTemplate::FileSystemTemplateLoader
+    FileLookup lookup;
+    const QStringList dirs = templateDirs();
+    for (const QString &dir : dirs) {
+        const QString candidate = dir + QLatin1Char('/') + themeName() + QLatin1Char('/') + name;
+        if (QFile::exists(candidate)) {
+            lookup.path = candidate;
+            break;
+        }
+    }
+    if (lookup.path.isEmpty()) {
+        lookup.directoryTimes = themeDirectoryTimes();
+        lookup.revalidate.setRemainingTime(revalidateInterval);
+    }
+    it = mFilePaths.insert(name, lookup);
+    addCacheMemoryLocked((name.size() + lookup.path.size()) * qint64(sizeof(QChar)));
+    return it->path;
+}
+
+QList<QDateTime> QtResourceTemplateLoader::themeDirectoryTimes() const
+{
+    QList<QDateTime> times;
+    const QStringList dirs = templateDirs();
+    times.reserve(dirs.size());
+    for (const QString &dir : dirs) {
+        times.push_back(QFileInfo(dir + QLatin1Char('/') + themeName()).lastModified());
+    }
+    return times;
+}
+
+void QtResourceTemplateLoader::forgetFileLocked(const QString &name) const
+{
+    const auto it = mFilePaths.constFind(name);
+    if (it == mFilePaths.constEnd()) {
+        return;
+    }
+    qint64 size = (name.size() + it->path.size()) * qint64(sizeof(QChar));
+    size += mFileTemplates.value(it->path).size;
+    mFileTemplates.remove(it->path);
+    mFilePaths.erase(it);
+    addCacheMemoryLocked(-size);
+}
+
+void QtResourceTemplateLoader::addCacheMemoryLocked(qint64 size) const
+{
+    mCacheMemory += size;
+    FormatterStatistics::addCacheMemory(size);
 }
 
 bool QtResourceTemplateLoader::canLoadTemplate(const QString &name) const
 {
+    QMutexLocker locker(&mCacheMutex);
     // Qt resource file
     if (name.startsWith(QLatin1String(":/"))) {
-        QFile file;
-        file.setFileName(name);
-
-        if (!file.exists() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            return false;
-        }
-        file.close();
-        return true;
+        return mCache.contains(name) || resourceExistsLocked(name);
     } else {
-        return KTextTemplate::FileSystemTemplateLoader::canLoadTemplate(name);
+        return !filePathLocked(name).isEmpty();
     }
 }
@@ -7,6 +7,10 @@
 
 #pragma once
 #include <KTextTemplate/TemplateLoader>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 
 namespace KCalUtils
@@ -18,5 +22,61 @@ public:
 
     [[nodiscard]] KTextTemplate::Template loadByName(const QString &fileName, const KTextTemplate::Engine *engine) const override;
     [[nodiscard]] bool canLoadTemplate(const QString &name) const override;
+
+    /**
+      Discards the parsed templates and the results of the file lookups,
+      e.g. after the template directories or the plugin paths changed.
+      Otherwise templates in the template directories are checked for
+      changes at most every revalidateInterval milliseconds.
+    */
+    void clearCache();
+
+    /**
+      Moves the parsed templates to @p thread, for handing the engine that
+      parsed them over to it. Must be called from the thread they live in.
+    */
+    void moveToThread(QThread *thread);
+
+    static constexpr int revalidateInterval = 2000;
+
+private:
+    struct FileTemplate {
+        QDateTime lastModified;
+        KTextTemplate::Template tpl;
+        qint64 size = 0;
+        // When to compare the modification time of the file again
+        QDeadlineTimer revalidate;
+    };
+
+    struct FileLookup {
+        // Empty if the template was not found
+        QString path;
+        // Modification times of the theme directories when the template was
+        // not found; a file added since changes them
+        QList<QDateTime> directoryTimes;
+        // When to compare the modification times of the directories again
+        QDeadlineTimer revalidate;
+    };
+
+    void clearCacheLocked() const;
+    void useEngineLocked(const KTextTemplate::Engine *engine) const;
+    [[nodiscard]] bool resourceExistsLocked(const QString &name) const;
+    [[nodiscard]] QString filePathLocked(const QString &name) const;
+    [[nodiscard]] QList<QDateTime> themeDirectoryTimes() const;
+    void forgetFileLocked(const QString &name) const;
+    void addCacheMemoryLocked(qint64 size) const;
+
+    // Templates compiled into the library never change, so they are
+    // parsed once and shared by all renderings.
+    mutable QMutex mCacheMutex;
+    mutable QHash<QString, KTextTemplate::Template> mCache;
+    // Whether each resource looked up so far exists
+    mutable QHash<QString, bool> mResources;
+    // Result of each lookup in the template directories so far
+    mutable QHash<QString, FileLookup> mFilePaths;
+    // Templates from the template directories, parsed again when modified
+    mutable QHash<QString, FileTemplate> mFileTemplates;
+    mutable const KTextTemplate::Engine *mCacheEngine = nullptr;
+    mutable qint64 mCacheMemory = 0;
 };
 }
@@ -0,0 +1,151 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "tracing.h"
+#include "kcalutils_debug.h"
+#include "tracing_p.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+
+#include <chrono>
+
+using namespace KCalUtils;
+
+namespace
+{
+// Keeps a forgotten setEnabled(true) in a long-running process from
+// growing without bounds
+constexpr int maxEvents = 1000000;
+
+struct TraceEvent {
+    const char *name;
+    QString detail;
+    qint64 start;
+    qint64 duration;
+    int thread;
+};
+
+class TraceState
+{
+public:
+    TraceState()
+        : mFileName(qEnvironmentVariable("KCALUTILS_TRACE_FILE"))
+    {
+        if (!mFileName.isEmpty()) {
+            Tracing::sActive.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    ~TraceState()
+    {
+        // Logging is no longer safe this late, failures are ignored
+        if (!mFileName.isEmpty()) {
+            QFile file(mFileName);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                file.write(toJson());
+            }
+        }
+    }
+
+    QByteArray toJson()
+    {
+        const qint64 pid = QCoreApplication::applicationPid();
+        QJsonArray events;
+        QMutexLocker locker(&mMutex);
+        for (const TraceEvent &event : std::as_const(mEvents)) {
+            QJsonObject object;
+            object[QStringLiteral("name")] = QLatin1StringView(event.name);
+            object[QStringLiteral("cat")] = QStringLiteral("kcalutils");
+            object[QStringLiteral("ph")] = QStringLiteral("X");
+            object[QStringLiteral("ts")] = event.start / 1000.0;
+            object[QStringLiteral("dur")] = event.duration / 1000.0;
+            object[QStringLiteral("pid")] = pid;
+            object[QStringLiteral("tid")] = event.thread;
+            if (!event.detail.isEmpty()) {
+                object[QStringLiteral("args")] = QJsonObject{{QStringLiteral("detail"), event.detail}};
+            }
+            events.append(object);
+        }
+        locker.unlock();
+
+        QJsonObject root;
+        root[QStringLiteral("traceEvents")] = events;
+        root[QStringLiteral("displayTimeUnit")] = QStringLiteral("ms");
+        return QJsonDocument(root).toJson(QJsonDocument::Compact);
+    }
+
+    const QString mFileName;
+    QMutex mMutex;
+    QList<TraceEvent> mEvents;
+};
+
+int currentThreadIndex()
+{
+    static std::atomic<int> nextIndex{1};
+    thread_local const int index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+}
+
+std::atomic<bool> Tracing::sActive{false};
+
+// Constructed after sActive, which it may enable
+static TraceState sState;
+
+qint64 Tracing::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracing::record(const char *name, const QString &detail, qint64 start, qint64 end)
+{
+    const int thread = currentThreadIndex();
+    QMutexLocker locker(&sState.mMutex);
+    if (sState.mEvents.size() < maxEvents) {
+        sState.mEvents.append({name, detail, start, end - start, thread});
+    }
+}
+
+void Tracing::setEnabled(bool enabled)
+{
+    sActive.store(enabled, std::memory_order_relaxed);
+}
+
+bool Tracing::isEnabled()
+{
+    return sActive.load(std::memory_order_relaxed);
+}
+
+void Tracing::clear()
+{
+    QMutexLocker locker(&sState.mMutex);
+    sState.mEvents.clear();
+}
+
+QByteArray Tracing::toChromeTrace()
+{
+    return sState.toJson();
+}
+
+bool Tracing::writeChromeTrace(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KCALUTILS_LOG) << "Unable to open" << fileName << "for writing:" << file.errorString();
+        return false;
+    }
+    if (file.write(toChromeTrace()) < 0) {
+        qCWarning(KCALUTILS_LOG) << "Unable to write to" << fileName << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
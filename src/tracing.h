@@ -0,0 +1,61 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+/**
+  @file
+  This file is part of the API for handling calendar data and provides
+  functions to trace where the time goes when formatting incidences.
+*/
+#pragma once
+
+#include "kcalutilscore_export.h"
+
+#include <QByteArray>
+#include <QString>
+
+namespace KCalUtils
+{
+/**
+  @brief
+  Records the phases of the formatter pipeline (parsing, lookups in the
+  calendar, building the template context, template rendering) as spans.
+
+  Tracing is disabled by default and costs next to nothing then. The
+  recorded spans can be exported in the Chrome trace event format and opened
+  in chrome://tracing or https://ui.perfetto.dev.
+
+  If the KCALUTILS_TRACE_FILE environment variable is set, tracing is
+  enabled when the library is loaded and the trace is written to that file
+  when the process exits.
+*/
+namespace Tracing
+{
+/**
+  Enables or disables recording of spans. Spans recorded so far are kept.
+*/
+KCALUTILSCORE_EXPORT void setEnabled(bool enabled);
+
+/**
+  Returns true if spans are being recorded.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT bool isEnabled();
+
+/**
+  Discards all spans recorded so far.
+*/
+KCALUTILSCORE_EXPORT void clear();
+
+/**
+  Returns the spans recorded so far as Chrome trace event JSON.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT QByteArray toChromeTrace();
+
+/**
+  Writes the spans recorded so far as Chrome trace event JSON to @p fileName.
+  @return true on success, false if the file could not be written.
+*/
+[[nodiscard]] KCALUTILSCORE_EXPORT bool writeChromeTrace(const QString &fileName);
+}
+}
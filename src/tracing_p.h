@@ -0,0 +1,59 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+
+namespace KCalUtils
+{
+namespace Tracing
+{
+extern std::atomic<bool> sActive;
+
+[[nodiscard]] qint64 now();
+void record(const char *name, const QString &detail, qint64 start, qint64 end);
+
+/**
+  Records the time between its construction and its destruction (or the
+  call to end()) as a span named @p name, if tracing is enabled.
+  @p name must be a string literal.
+*/
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name, const QString &detail = QString())
+        : mName(sActive.load(std::memory_order_relaxed) ? name : nullptr)
+    {
+        if (mName) {
+            mDetail = detail;
+            mStart = now();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        end();
+    }
+
+    void end()
+    {
+        if (mName) {
+            record(mName, mDetail, mStart, now());
+            mName = nullptr;
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+    const char *mName;
+    QString mDetail;
+    qint64 mStart = 0;
+};
+}
+}
@@ -8,7 +8,7 @@
 */
 #pragma once
 
-#include "kcalutils_export.h"
+#include "kcalutilscore_export.h"
 #include <KCalendarCore/Calendar>
 
 class QMimeData;
@@ -23,16 +23,16 @@ namespace VCalDrag
 /**
   Mime-type of iCalendar
 */
-[[nodiscard]] KCALUTILS_EXPORT QString mimeType();
+[[nodiscard]] KCALUTILSCORE_EXPORT QString mimeType();
 
 /**
   Return, if drag&drop object can be decode to vCalendar.
 */
-[[nodiscard]] KCALUTILS_EXPORT bool canDecode(const QMimeData *);
+[[nodiscard]] KCALUTILSCORE_EXPORT bool canDecode(const QMimeData *);
 
 /**
   Decode drag&drop object to vCalendar component \a vcal.
 */
-[[nodiscard]] KCALUTILS_EXPORT bool fromMimeData(const QMimeData *e, const KCalendarCore::Calendar::Ptr &cal);
+[[nodiscard]] KCALUTILSCORE_EXPORT bool fromMimeData(const QMimeData *e, const KCalendarCore::Calendar::Ptr &cal);
 }
 }
@@ -0,0 +1,307 @@
+/*
+  This file is part of the kcalutils library.
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "incidenceformatter.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <KIdentityManagementCore/IdentityManager>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRunnable>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimeZone>
+
+#include <atomic>
+#include <vector>
+
+using namespace KCalendarCore;
+using namespace KCalUtils;
+
+namespace
+{
+enum class Mode {
+    Display,
+    Invitation,
+    MailBody,
+    ToolTip,
+};
+
+struct Input {
+    QString name;
+    QByteArray data;
+};
+
+struct Result {
+    QString output;
+    int incidences = 0;
+    bool ok = false;
+};
+
+// Renders every incidence of the calendar in @p data, or the iTIP message
+Result render(Mode mode, const QByteArray &data)
+{
+    Result result;
+    const QString text = QString::fromUtf8(data);
+
+    if (mode == Mode::Invitation) {
+        MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::systemTimeZone()));
+        InvitationFormatterHelper helper;
+        result.output = IncidenceFormatter::formatICalInvitation(text, calendar, &helper);
+        result.incidences = 1;
+        result.ok = !result.output.isEmpty();
+        return result;
+    }
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::systemTimeZone()));
+    ICalFormat format;
+    if (!format.fromString(calendar, text)) {
+        return result;
+    }
+    const Incidence::List incidences = calendar->incidences();
+    for (const Incidence::Ptr &incidence : incidences) {
+        switch (mode) {
+        case Mode::Display:
+            result.output += IncidenceFormatter::extensiveDisplayStr(calendar, incidence);
+            break;
+        case Mode::MailBody:
+            result.output += IncidenceFormatter::mailBodyStr(incidence);
+            break;
+        case Mode::ToolTip:
+            result.output += IncidenceFormatter::toolTipStr(QString(), incidence);
+            break;
+        case Mode::Invitation:
+            break;
+        }
+        result.output += QLatin1Char('\n');
+        ++result.incidences;
+    }
+    result.ok = true;
+    return result;
+}
+
+bool collectInputs(const QStringList &paths, std::vector<Input> &inputs)
+{
+    if (paths.isEmpty() || paths == QStringList{QStringLiteral("-")}) {
+        QFile in;
+        if (!in.open(stdin, QIODevice::ReadOnly)) {
+            qWarning("Unable to read from stdin");
+            return false;
+        }
+        inputs.push_back({QStringLiteral("stdin"), in.readAll()});
+        return true;
+    }
+
+    QStringList files;
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (info.isDir()) {
+            const QDir dir(path);
+            const QStringList entries = dir.entryList({QStringLiteral("*.ics"), QStringLiteral("*.ical"), QStringLiteral("*.ifb")}, QDir::Files, QDir::Name);
+            for (const QString &entry : entries) {
+                files.append(dir.filePath(entry));
+            }
+        } else {
+            files.append(path);
+        }
+    }
+
+    for (const QString &fileName : std::as_const(files)) {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning("Unable to read %s: %s", qPrintable(fileName), qPrintable(file.errorString()));
+            return false;
+        }
+        inputs.push_back({fileName, file.readAll()});
+    }
+    return true;
+}
+
+// Names the output file of each input after it. Inputs whose names would
+// collide, e.g. a/x.ics and b/x.ics or x.ics and x.ical, get a number
+// appended, so that no two worker threads write the same file.
+QStringList outputFileNames(const std::vector<Input> &inputs, const QString &suffix)
+{
+    // Compared in lower case, case-insensitive file systems would merge names
+    // differing in case
+    QStringList baseNames;
+    QHash<QString, int> counts;
+    for (const Input &input : inputs) {
+        baseNames.append(QFileInfo(input.name).completeBaseName());
+        ++counts[baseNames.constLast().toLower()];
+    }
+
+    QSet<QString> used;
+    for (const QString &baseName : std::as_const(baseNames)) {
+        if (counts.value(baseName.toLower()) == 1) {
+            used.insert(baseName.toLower());
+        }
+    }
+
+    QStringList fileNames;
+    fileNames.reserve(baseNames.size());
+    for (int i = 0; i < baseNames.size(); ++i) {
+        QString name = baseNames.at(i);
+        if (counts.value(name.toLower()) > 1) {
+            int number = i + 1;
+            while (used.contains(QStringLiteral("%1-%2").arg(name).arg(number).toLower())) {
+                ++number;
+            }
+            name = QStringLiteral("%1-%2").arg(name).arg(number);
+            used.insert(name.toLower());
+        }
+        fileNames.append(name + suffix);
+    }
+    return fileNames;
+}
+
+bool writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Unable to write %s: %s", qPrintable(fileName), qPrintable(file.errorString()));
+        return false;
+    }
+    return file.write(data) >= 0;
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kcalutils-render"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Renders calendars or iTIP messages to HTML with a pool of worker threads"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("inputs"),
+                                 QStringLiteral("Files or directories (*.ics, *.ical, *.ifb) to render, reads stdin if none or -."),
+                                 QStringLiteral("[inputs...]"));
+
+    const QCommandLineOption modeOption(QStringLiteral("mode"),
+                                        QStringLiteral("What to render: display, invitation, mailbody or tooltip."),
+                                        QStringLiteral("mode"),
+                                        QStringLiteral("display"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"),
+                                           QStringLiteral("Number of worker threads, the number of CPU cores by default."),
+                                           QStringLiteral("n"),
+                                           QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption repeatOption(QStringLiteral("repeat"),
+                                          QStringLiteral("Render every input <n> times, to use the tool as a benchmark."),
+                                          QStringLiteral("n"),
+                                          QStringLiteral("1"));
+    const QCommandLineOption outputOption(QStringLiteral("output-dir"),
+                                          QStringLiteral("Write one file per input to <dir> instead of writing to stdout. Inputs with the same base name get a number appended."),
+                                          QStringLiteral("dir"));
+    const QCommandLineOption quietOption(QStringLiteral("quiet"), QStringLiteral("Do not write the rendered output, only the statistics."));
+    parser.addOptions({modeOption, threadsOption, repeatOption, outputOption, quietOption});
+    parser.process(app);
+
+    const QString modeName = parser.value(modeOption);
+    Mode mode = Mode::Display;
+    if (modeName == QLatin1StringView("invitation")) {
+        mode = Mode::Invitation;
+    } else if (modeName == QLatin1StringView("mailbody")) {
+        mode = Mode::MailBody;
+    } else if (modeName == QLatin1StringView("tooltip")) {
+        mode = Mode::ToolTip;
+    } else if (modeName != QLatin1StringView("display")) {
+        qWarning("Unknown mode %s", qPrintable(modeName));
+        parser.showHelp(1);
+    }
+    const int threads = qMax(1, parser.value(threadsOption).toInt());
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+    const bool quiet = parser.isSet(quietOption);
+    const QString outputDir = parser.value(outputOption);
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        qWarning("Unable to create %s", qPrintable(outputDir));
+        return 1;
+    }
+
+    std::vector<Input> inputs;
+    if (!collectInputs(parser.positionalArguments(), inputs)) {
+        return 1;
+    }
+
+    const QString suffix = mode == Mode::MailBody ? QStringLiteral(".txt") : QStringLiteral(".html");
+    const QStringList outputNames = outputFileNames(inputs, suffix);
+    std::vector<Result> results(inputs.size());
+    std::atomic<int> incidences{0};
+    std::atomic<int> failures{0};
+    std::atomic<qint64> bytes{0};
+
+    // Create the identity manager here rather than from the first worker
+    // thread that checks whether the user is an attendee
+    (void)KIdentityManagementCore::IdentityManager::self();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        pool.start([&, i]() {
+            Result result;
+            for (int r = 0; r < repeat; ++r) {
+                result = render(mode, inputs[i].data);
+                incidences += result.incidences;
+            }
+            inputs[i].data = QByteArray();
+            // The output is written as UTF-8, and is the same on every repetition
+            const QByteArray output = result.output.toUtf8();
+            bytes += output.size() * qint64(repeat);
+            if (!result.ok) {
+                qWarning("Unable to render %s", qPrintable(inputs[i].name));
+                ++failures;
+            } else if (!quiet && !outputDir.isEmpty()) {
+                const QString fileName = QDir(outputDir).filePath(outputNames.at(int(i)));
+                if (!writeFile(fileName, output)) {
+                    ++failures;
+                }
+            }
+            // Only the output for stdout is kept until all inputs are rendered
+            if (!quiet && outputDir.isEmpty()) {
+                results[i] = std::move(result);
+            }
+        });
+    }
+    pool.waitForDone();
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    if (!quiet && outputDir.isEmpty()) {
+        QTextStream out(stdout);
+        for (const Result &result : results) {
+            out << result.output;
+        }
+    }
+
+    const double seconds = elapsed / 1e9;
+    const int renders = int(inputs.size()) * repeat;
+    QTextStream err(stderr);
+    err << "Rendered " << renders << " inputs (" << incidences.load() << " incidences) with " << threads << " threads in " << seconds * 1000 << " ms\n";
+    if (seconds > 0) {
+        err << "Throughput: " << renders / seconds << " inputs/s, " << incidences.load() / seconds << " incidences/s, "
+            << bytes.load() / seconds / (1024 * 1024) << " MiB/s of UTF-8 output\n";
+    }
+    const IncidenceFormatter::Statistics stats = IncidenceFormatter::statistics();
+    err << "Time in phases: parse " << stats.phaseNanoseconds(IncidenceFormatter::Statistics::ParsePhase) / 1e6 << " ms, lookup "
+        << stats.phaseNanoseconds(IncidenceFormatter::Statistics::LookupPhase) / 1e6 << " ms, render "
+        << stats.phaseNanoseconds(IncidenceFormatter::Statistics::RenderPhase) / 1e6 << " ms\n";
+    if (failures > 0) {
+        err << failures.load() << " inputs failed\n";
+        return 1;
+    }
+    return 0;
+}